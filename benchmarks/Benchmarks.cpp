@@ -34,3 +34,331 @@ TEST_CASE ("Boot performance")
         });
     };
 }
+
+TEST_CASE ("Preset parsing")
+{
+    // A 10k-preset corpus, as a bulk import would see it
+    constexpr int numPresets = 10000;
+    std::vector<juce::MemoryBlock> corpus;
+    corpus.reserve (numPresets);
+
+    juce::Random random (42);
+    for (int i = 0; i < numPresets; ++i)
+    {
+        PresetFields fields;
+        fields.morphValue = random.nextFloat();
+        for (size_t h = 0; h < fields.harm1.size(); ++h)
+        {
+            fields.harm1[h] = random.nextFloat();
+            fields.harm2[h] = random.nextFloat();
+            fields.combo[h] = random.nextFloat();
+        }
+
+        juce::MemoryOutputStream out;
+        PresetWriter::write (fields, out);
+        corpus.push_back (out.getMemoryBlock());
+    }
+
+    BENCHMARK ("Streaming reader, 10k presets")
+    {
+        PresetFields fields;
+        float sum = 0.0f;
+        for (const auto& block : corpus)
+        {
+            PresetReader::parse (static_cast<const char*> (block.getData()), block.getSize(), fields);
+            sum += fields.combo[0];
+        }
+        return sum;
+    };
+
+    BENCHMARK ("XmlDocument + ValueTree, 10k presets")
+    {
+        float sum = 0.0f;
+        for (const auto& block : corpus)
+        {
+            if (auto xml = juce::XmlDocument::parse (block.toString()))
+            {
+                auto preset = juce::ValueTree::fromXml (*xml);
+                auto comboTree = preset.getChildWithName ("COMBO");
+                for (int h = 0; h < 8; ++h)
+                    sum += (float) comboTree.getProperty ("h" + juce::String (h));
+            }
+        }
+        return sum;
+    };
+
+    BENCHMARK_ADVANCED ("Streaming writer, 10k presets")
+    (Catch::Benchmark::Chronometer meter)
+    {
+        PresetFields fields;
+        juce::MemoryOutputStream out (1024);
+        meter.measure ([&] {
+            for (int i = 0; i < numPresets; ++i)
+            {
+                out.reset();
+                fields.morphValue = (float) i / numPresets;
+                PresetWriter::write (fields, out);
+            }
+            return out.getDataSize();
+        });
+    };
+}
+
+TEST_CASE ("Similar preset search")
+{
+    // A 50k-preset library, searched the way one pool job searches its chunk
+    std::vector<PresetBank::Entry> entries (50000);
+    juce::Random random (7);
+    for (auto& entry : entries)
+        for (auto& value : entry.fields.combo)
+            value = random.nextFloat();
+
+    auto index = PresetLibrary::createIndex (entries);
+
+    HarmonicTable query {};
+    for (auto& value : query)
+        value = random.nextFloat();
+
+    BENCHMARK ("k=10 nearest of 50k presets, one thread")
+    {
+        std::vector<PresetLibrary::Match> best;
+        best.reserve (11);
+        PresetLibrary::findNearest (index->getVectors(), 0, index->getNumPresets(), query.data(), 10, best);
+        return best.front().index;
+    };
+}
+
+TEST_CASE ("Pitch tracking")
+{
+    // One second of a sung-range sine, fed in host-sized blocks
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    juce::AudioBuffer<float> audio (1, (int) sampleRate);
+    for (int i = 0; i < audio.getNumSamples(); ++i)
+        audio.setSample (0, i, 0.5f * std::sin (juce::MathConstants<float>::twoPi * 220.0f * (float) i / (float) sampleRate));
+
+    PitchTracker tracker;
+    tracker.prepare (sampleRate, blockSize);
+    juce::MidiBuffer midi;
+    midi.ensureSize (1024);
+
+    BENCHMARK ("1 s of 48 kHz audio, one channel")
+    {
+        for (int start = 0; start < audio.getNumSamples(); start += blockSize)
+        {
+            const float* channel = audio.getReadPointer (0, start);
+            tracker.process (&channel, 1, juce::jmin (blockSize, audio.getNumSamples() - start), midi);
+            midi.clear();
+        }
+        return tracker.getCurrentNote();
+    };
+}
+
+TEST_CASE ("Additive synth")
+{
+    // One second at 48 kHz: the time per run is the share of a core taken
+    // by that many voices, each a fundamental plus every harmonic
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    HarmonicTable table;
+    table.fill (0.5f);
+    TableCrossfader tables;
+    tables.prepare (sampleRate);
+    tables.setTarget (table, false);
+
+    juce::AudioBuffer<float> audio (2, blockSize);
+    juce::MidiBuffer noEvents;
+
+    auto renderSecond = [&] (AdditiveSynth& synth) {
+        for (int rendered = 0; rendered < (int) sampleRate; rendered += blockSize)
+        {
+            audio.clear();
+            synth.render (audio, noEvents, tables);
+        }
+        return audio.getSample (0, 0);
+    };
+
+    for (int voices : { 16, 64, 128 })
+    {
+        AdditiveSynth synth;
+        synth.prepare (sampleRate, blockSize);
+
+        juce::MidiBuffer notes;
+        for (int v = 0; v < voices; ++v)
+            notes.addEvent (juce::MidiMessage::noteOn (1, 24 + v % 72, 0.5f), 0);
+        synth.render (audio, notes, tables);
+
+        BENCHMARK (std::to_string (voices) + " voices x " + std::to_string (AdditiveSynth::partialsPerVoice) + " partials, 1 s")
+        {
+            return renderSecond (synth);
+        };
+
+        // How many partials of this kind one core keeps up with in realtime
+        const auto start = juce::Time::getHighResolutionTicks();
+        renderSecond (synth);
+        const auto seconds = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start);
+        WARN (voices << " voices: about " << juce::roundToInt (synth.getNumActivePartials() / seconds) << " partials per core");
+    }
+}
+
+TEST_CASE ("Additive synth threads")
+{
+    // A full synth, one second at 48 kHz, spread over more and more cores
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    HarmonicTable table;
+    table.fill (0.5f);
+    TableCrossfader tables;
+    tables.prepare (sampleRate);
+    tables.setTarget (table, false);
+
+    juce::MidiBuffer notes;
+    for (int v = 0; v < AdditiveSynth::maxVoices; ++v)
+        notes.addEvent (juce::MidiMessage::noteOn (1, 24 + v % 72, 0.5f), 0);
+
+    juce::AudioBuffer<float> audio (2, blockSize);
+    juce::MidiBuffer noEvents;
+
+    for (int threads : { 1, 2, 4, 8 })
+    {
+        AdditiveSynth synth;
+        synth.prepare (sampleRate, blockSize);
+        synth.setNumThreads (threads);
+        synth.render (audio, notes, tables);
+
+        BENCHMARK (std::to_string (AdditiveSynth::maxVoices) + " voices, " + std::to_string (threads) + " threads, 1 s")
+        {
+            for (int rendered = 0; rendered < (int) sampleRate; rendered += blockSize)
+            {
+                audio.clear();
+                synth.render (audio, noEvents, tables);
+            }
+            return audio.getSample (0, 0);
+        };
+    }
+}
+
+TEST_CASE ("Wavetable export")
+{
+    // One preset's sweep on one thread; a library export spreads these over the pool
+    WavetableExporter::Job job;
+    job.from.fill (0.2f);
+    job.to.fill (0.8f);
+    job.numFrames = MorphEngine::numSteps;
+
+    const WavetableExporter::Options options;
+    std::vector<float> frames ((size_t) job.numFrames * (size_t) options.frameSize);
+
+    BENCHMARK ("256 frames of 2048 samples, one thread")
+    {
+        WavetableExporter::renderFrames (job, options, 0, job.numFrames, frames.data());
+        return frames[1];
+    };
+}
+
+TEST_CASE ("Sample analysis")
+{
+    // Ten seconds of a harmonic tone, the size of a typical sustained sample
+    constexpr double sampleRate = 48000.0;
+    juce::AudioBuffer<float> tone (1, 10 * 48000);
+    for (int i = 0; i < tone.getNumSamples(); ++i)
+    {
+        const float phase = juce::MathConstants<float>::twoPi * 220.0f * (float) i / (float) sampleRate;
+        tone.setSample (0, i, 0.5f * std::sin (phase) + 0.25f * std::sin (2.0f * phase) + 0.1f * std::sin (3.0f * phase));
+    }
+
+    const SampleAnalyser::Options options;
+
+    BENCHMARK ("Fundamental of 2 s")
+    {
+        return SampleAnalyser::estimateFundamental (tone.getReadPointer (0), 2 * 48000, sampleRate);
+    };
+
+    BENCHMARK ("Whole file on one thread")
+    {
+        SampleAnalyser::Result result;
+        SampleAnalyser::analyseBuffer (tone, sampleRate, options, result);
+        return result.table[0];
+    };
+}
+
+TEST_CASE ("Generator kernels")
+{
+    // A dense block: a note-on and a pressure change every sample, with a two-partial table
+    constexpr int blockSize = 512;
+    juce::MidiBuffer dense;
+    for (int i = 0; i < blockSize; ++i)
+    {
+        dense.addEvent (juce::MidiMessage::noteOn (1, 36 + i % 48, (juce::uint8) 100), i);
+        dense.addEvent (juce::MidiMessage::aftertouchChange (1, 36 + i % 48, i % 128), i);
+    }
+
+    HarmonicTable table {};
+    table[0] = 1.0f;
+    table[1] = 0.5f;
+
+    for (const bool generic : { false, true })
+    {
+        HarmonicGenerator generator;
+        generator.prepare (blockSize);
+        generator.setUseGenericKernel (generic);
+
+        juce::MidiBuffer midi;
+        midi.ensureSize (dense.data.size() * 4);
+
+        BENCHMARK (std::string (generic ? "Generic" : "Specialised") + " kernel, dense " + std::to_string (blockSize) + " sample block")
+        {
+            midi = dense;
+            generator.process (midi, table, blockSize);
+            return midi.getNumEvents();
+        };
+    }
+}
+
+TEST_CASE ("processBlock")
+{
+    constexpr int blockSize = 512;
+    PluginProcessor plugin;
+    plugin.prepareToPlay (48000.0, blockSize);
+
+    juce::Array<float> strengths;
+    for (int i = 0; i < HarmonicSeries::numHarmonics; ++i)
+        strengths.add (1.0f / (float) (i + 1));
+    plugin.setHarmonicData (strengths, strengths, strengths);
+
+    juce::AudioBuffer<float> audio (plugin.getTotalNumOutputChannels(), blockSize);
+
+    // What most blocks in a session look like: clock and a couple of controllers
+    juce::MidiBuffer clockOnly;
+    for (int i = 0; i < blockSize; i += 24)
+        clockOnly.addEvent (juce::MidiMessage::midiClock(), i);
+    clockOnly.addEvent (juce::MidiMessage::controllerEvent (1, 1, 64), 100);
+    clockOnly.addEvent (juce::MidiMessage::controllerEvent (1, 7, 100), 200);
+
+    juce::MidiBuffer withNotes = clockOnly;
+    for (int i = 0; i < 8; ++i)
+    {
+        withNotes.addEvent (juce::MidiMessage::noteOn (1, 48 + i, (juce::uint8) 100), i * 16);
+        withNotes.addEvent (juce::MidiMessage::noteOff (1, 48 + i), 256 + i * 16);
+    }
+
+    juce::MidiBuffer midi;
+    midi.ensureSize (4096);
+
+    BENCHMARK ("Clock and controllers only, " + std::to_string (blockSize) + " samples")
+    {
+        midi = clockOnly;
+        plugin.processBlock (audio, midi);
+        return midi.getNumEvents();
+    };
+
+    BENCHMARK ("8 notes with clock and controllers, " + std::to_string (blockSize) + " samples")
+    {
+        midi = withNotes;
+        plugin.processBlock (audio, midi);
+        return midi.getNumEvents();
+    };
+}
@@ -0,0 +1,83 @@
+#include "HeapUsage.h"
+#include <PluginEditor.h>
+#include <catch2/catch_test_macros.hpp>
+
+// Heap budgets per instance. Big templates run hundreds of these, so memory
+// is what limits them. Keep them about 25% above what FootprintReport
+// prints for a release build (it prints that figure too): a change that
+// needs more should raise them deliberately, not by accident.
+//
+// Measured on Linux with glibc, 48 kHz and 512-sample blocks, the
+// allocations the plugin's own code makes for one prepared instance come
+// to 1245 KiB in 30 blocks. 684 KiB of that, in 19 blocks, comes from
+// prepareToPlay(). The processor's byte budget adds room for JUCE's
+// parameter tree and FFT on top. Its block budget and the editor budgets
+// are still ceilings, not measurements.
+static constexpr std::int64_t processorBudgetBytes = 2 * 1024 * 1024;
+static constexpr std::int64_t processorBudgetBlocks = 20000;
+static constexpr std::int64_t editorBudgetBytes = 16 * 1024 * 1024;
+static constexpr std::int64_t editorBudgetBlocks = 100000;
+
+TEST_CASE ("Instance footprint", "[footprint]")
+{
+    if (! HeapUsage::isAvailable())
+        SKIP ("No heap statistics on this platform");
+
+    SECTION ("parameter layout")
+    {
+        HeapScope scope;
+        auto layout = PluginProcessor::createParameterLayout();
+
+        CHECK (scope.getLiveBytes() < processorBudgetBytes / 8);
+    }
+
+    SECTION ("processor, constructed and prepared")
+    {
+        HeapScope scope;
+        auto plugin = std::make_unique<PluginProcessor>();
+        plugin->prepareToPlay (48000.0, 512);
+
+        CHECK (scope.getLiveBytes() < processorBudgetBytes);
+        CHECK (scope.getLiveBlocks() < processorBudgetBlocks);
+    }
+
+    SECTION ("open editor")
+    {
+        PluginProcessor plugin;
+
+        HeapScope scope;
+        auto* editor = plugin.createEditorIfNeeded();
+
+        CHECK (scope.getLiveBytes() < editorBudgetBytes);
+        CHECK (scope.getLiveBlocks() < editorBudgetBlocks);
+
+        plugin.editorBeingDeleted (editor);
+        delete editor;
+    }
+
+    SECTION ("200 instances grow linearly")
+    {
+        // The first instance also pays for anything shared, so it bounds the
+        // rest. Instances start no threads of their own (background work goes
+        // to shared pools on demand), so 200 of them don't swamp the machine
+        HeapScope firstScope;
+        auto first = std::make_unique<PluginProcessor>();
+        first->prepareToPlay (48000.0, 512);
+        const auto perInstance = firstScope.getLiveBytes();
+
+        std::vector<std::unique_ptr<PluginProcessor>> instances;
+        instances.reserve (199);
+
+        HeapScope scope;
+        for (int i = 0; i < 199; ++i)
+        {
+            instances.push_back (std::make_unique<PluginProcessor>());
+            instances.back()->prepareToPlay (48000.0, 512);
+        }
+
+        CHECK (scope.getLiveBytes() + perInstance < 200 * processorBudgetBytes);
+
+        // Slack for whatever JUCE's own threads allocate meanwhile
+        CHECK (scope.getLiveBytes() / 199 <= perInstance + perInstance / 20);
+    }
+}
@@ -0,0 +1,63 @@
+#include "HeapUsage.h"
+#include <PluginEditor.h>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+// With the budget Footprint.cpp should have for it, 25% above what was measured
+static std::string describe (const HeapScope& scope)
+{
+    const auto bytes = scope.getLiveBytes();
+    const auto blocks = scope.getLiveBlocks();
+
+    return std::to_string (bytes / 1024) + " KiB held in " + std::to_string (blocks) + " blocks (budget "
+         + std::to_string (bytes * 5 / 4 / 1024) + " KiB, " + std::to_string (blocks * 5 / 4) + " blocks)";
+}
+
+TEST_CASE ("Instance footprint report", "[footprint][report]")
+{
+    if (! HeapUsage::isAvailable())
+        SKIP ("No heap statistics on this platform");
+
+    {
+        HeapScope scope;
+        auto layout = PluginProcessor::createParameterLayout();
+        WARN ("Parameter layout: " << describe (scope));
+    }
+
+    PluginProcessor plugin;
+    {
+        HeapScope scope;
+        PluginProcessor processor;
+        WARN ("Processor and APVTS: " << describe (scope));
+
+        processor.prepareToPlay (48000.0, 512);
+        WARN ("Processor after prepareToPlay: " << describe (scope));
+    }
+
+    {
+        HeapScope scope;
+        auto* editor = plugin.createEditorIfNeeded();
+        WARN ("Open editor: " << describe (scope));
+
+        plugin.editorBeingDeleted (editor);
+        delete editor;
+    }
+
+    {
+        HeapScope scope;
+        std::vector<std::unique_ptr<PluginProcessor>> instances;
+        for (int i = 0; i < 200; ++i)
+        {
+            instances.push_back (std::make_unique<PluginProcessor>());
+            instances.back()->prepareToPlay (48000.0, 512);
+        }
+        WARN ("200 prepared instances: " << describe (scope));
+    }
+
+    BENCHMARK ("Processor construct, prepare and destroy")
+    {
+        auto processor = std::make_unique<PluginProcessor>();
+        processor->prepareToPlay (48000.0, 512);
+        return processor->getLatencySamples();
+    };
+}
@@ -0,0 +1,154 @@
+#include "HeapUsage.h"
+
+#if defined(__APPLE__)
+    #include <malloc/malloc.h>
+#elif defined(_WIN32)
+    #define NOMINMAX
+    #define WIN32_LEAN_AND_MEAN
+    #include <malloc.h>
+    #include <windows.h>
+#elif defined(__GLIBC__)
+    #include <atomic>
+    #include <cerrno>
+    #include <malloc.h>
+#endif
+
+#if defined(__APPLE__)
+
+bool HeapUsage::isAvailable() { return true; }
+
+HeapUsage HeapUsage::now()
+{
+    // A null zone sums every zone, not just the default one
+    malloc_statistics_t statistics {};
+    malloc_zone_statistics (nullptr, &statistics);
+    return { (std::int64_t) statistics.size_in_use, (std::int64_t) statistics.blocks_in_use };
+}
+
+#elif defined(_WIN32)
+
+bool HeapUsage::isAvailable() { return true; }
+
+HeapUsage HeapUsage::now()
+{
+    // The CRT allocates from this heap. Walking it is slow, but footprint
+    // tests only look a few times
+    const auto heap = (HANDLE) _get_heap_handle();
+    HeapUsage usage;
+
+    if (! HeapLock (heap))
+        return usage;
+
+    PROCESS_HEAP_ENTRY entry {};
+    while (HeapWalk (heap, &entry))
+    {
+        if ((entry.wFlags & PROCESS_HEAP_ENTRY_BUSY) != 0)
+        {
+            usage.bytes += (std::int64_t) entry.cbData;
+            ++usage.blocks;
+        }
+    }
+
+    HeapUnlock (heap);
+    return usage;
+}
+
+#elif defined(__GLIBC__)
+
+namespace
+{
+    std::atomic<std::int64_t> liveBytes { 0 };
+    std::atomic<std::int64_t> liveBlocks { 0 };
+
+    void* allocated (void* block) noexcept
+    {
+        if (block != nullptr)
+        {
+            liveBytes.fetch_add ((std::int64_t) malloc_usable_size (block), std::memory_order_relaxed);
+            liveBlocks.fetch_add (1, std::memory_order_relaxed);
+        }
+
+        return block;
+    }
+
+    void released (void* block) noexcept
+    {
+        if (block != nullptr)
+        {
+            liveBytes.fetch_sub ((std::int64_t) malloc_usable_size (block), std::memory_order_relaxed);
+            liveBlocks.fetch_sub (1, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool HeapUsage::isAvailable() { return true; }
+
+HeapUsage HeapUsage::now()
+{
+    return { liveBytes.load(), liveBlocks.load() };
+}
+
+// glibc lets an executable replace its allocator, and then routes its own
+// allocations (strdup, fopen, thread stacks' bookkeeping) through it too.
+// These only count, the allocating is still glibc's.
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void* __libc_memalign (size_t, size_t);
+    void* __libc_valloc (size_t);
+    void* __libc_pvalloc (size_t);
+    void __libc_free (void*);
+
+    void* malloc (size_t size) noexcept { return allocated (__libc_malloc (size)); }
+    void* calloc (size_t count, size_t size) noexcept { return allocated (__libc_calloc (count, size)); }
+    void* memalign (size_t alignment, size_t size) noexcept { return allocated (__libc_memalign (alignment, size)); }
+    void* aligned_alloc (size_t alignment, size_t size) noexcept { return allocated (__libc_memalign (alignment, size)); }
+    void* valloc (size_t size) noexcept { return allocated (__libc_valloc (size)); }
+    void* pvalloc (size_t size) noexcept { return allocated (__libc_pvalloc (size)); }
+
+    void free (void* block) noexcept
+    {
+        released (block);
+        __libc_free (block);
+    }
+
+    void* realloc (void* block, size_t size) noexcept
+    {
+        // The old block is only gone if the new one came back (or size was 0)
+        const auto oldBytes = block != nullptr ? (std::int64_t) malloc_usable_size (block) : 0;
+        auto* moved = __libc_realloc (block, size);
+
+        if (moved == nullptr && size != 0)
+            return nullptr;
+
+        if (block != nullptr)
+        {
+            liveBytes.fetch_sub (oldBytes, std::memory_order_relaxed);
+            liveBlocks.fetch_sub (1, std::memory_order_relaxed);
+        }
+
+        return allocated (moved);
+    }
+
+    int posix_memalign (void** result, size_t alignment, size_t size) noexcept
+    {
+        if (alignment % sizeof (void*) != 0 || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+
+        auto* block = __libc_memalign (alignment, size);
+        if (block == nullptr)
+            return ENOMEM;
+
+        *result = allocated (block);
+        return 0;
+    }
+}
+
+#else
+
+bool HeapUsage::isAvailable() { return false; }
+HeapUsage HeapUsage::now() { return {}; }
+
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+
+/* Heap in use by the whole process, as the allocator itself sees it, so it
+ * covers malloc as well as new, and what JUCE, the system libraries and
+ * their threads allocate.
+ *
+ * macOS and Windows report it from their heap statistics. glibc has no
+ * count of blocks in use, so on Linux HeapUsage.cpp replaces malloc and
+ * friends with versions that keep one, which is why it only goes into the
+ * Footprint executable.
+ *
+ * Example usage
+ *
+  HeapScope scope;
+  auto plugin = std::make_unique<PluginProcessor>();
+  CHECK (scope.getLiveBytes() < budget);
+
+ */
+struct HeapUsage
+{
+    std::int64_t bytes = 0;  // in live blocks, including the allocator's rounding up
+    std::int64_t blocks = 0; // live allocations
+
+    // False where there's no way to tell, the footprint tests skip then
+    static bool isAvailable();
+    static HeapUsage now();
+};
+
+class HeapScope
+{
+public:
+    HeapScope() : start (HeapUsage::now()) {}
+
+    // What is still held of the allocations made since the scope opened,
+    // i.e. the footprint of whatever was built in the scope
+    std::int64_t getLiveBytes() const { return HeapUsage::now().bytes - start.bytes; }
+    std::int64_t getLiveBlocks() const { return HeapUsage::now().blocks - start.blocks; }
+
+private:
+    const HeapUsage start;
+};
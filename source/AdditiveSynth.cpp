@@ -0,0 +1,238 @@
+#include "AdditiveSynth.h"
+
+void AdditiveSynth::prepare (double newSampleRate, int newMaxBlockSize)
+{
+    sampleRate = newSampleRate;
+    maxBlockSize = juce::jmax (1, newMaxBlockSize);
+
+    phase.calloc ((size_t) partialCapacity);
+    increment.calloc ((size_t) partialCapacity);
+    amplitude.calloc ((size_t) partialCapacity);
+    amplitudeStep.calloc ((size_t) partialCapacity);
+    laneSums.calloc ((size_t) (VoiceRenderPool::maxThreads * maxBlockSize * laneWidth));
+    chunkOutput.calloc ((size_t) (maxChunks * maxBlockSize));
+    mono.calloc ((size_t) maxBlockSize);
+
+    setEnvelope (0.005f, 0.2f);
+    reset();
+}
+
+void AdditiveSynth::reset()
+{
+    numVoices = 0;
+    juce::FloatVectorOperations::clear (phase.get(), partialCapacity);
+    juce::FloatVectorOperations::clear (increment.get(), partialCapacity);
+    juce::FloatVectorOperations::clear (amplitude.get(), partialCapacity);
+    juce::FloatVectorOperations::clear (amplitudeStep.get(), partialCapacity);
+}
+
+void AdditiveSynth::setEnvelope (float attackSeconds, float releaseSeconds) noexcept
+{
+    attackStep = 1.0f / juce::jmax (1.0f, attackSeconds * (float) sampleRate);
+    releaseStep = 1.0f / juce::jmax (1.0f, releaseSeconds * (float) sampleRate);
+}
+
+void AdditiveSynth::render (juce::AudioBuffer<float>& out, const juce::MidiBuffer& midi, const TableCrossfader& tables)
+{
+    HarmonicTable table {};
+
+    for (int start = 0; start < out.getNumSamples(); start += maxBlockSize)
+    {
+        const int blockLength = juce::jmin (maxBlockSize, out.getNumSamples() - start);
+        const int blockEnd = start + blockLength;
+        juce::FloatVectorOperations::clear (mono.get(), blockLength);
+
+        // Sample accurate notes: render up to each event, then apply it
+        int position = start;
+        for (auto it = midi.findNextSamplePosition (start); it != midi.cend(); ++it)
+        {
+            const auto metadata = *it;
+            if (metadata.samplePosition >= blockEnd)
+                break;
+
+            if (metadata.samplePosition > position)
+            {
+                tables.getTableAt (metadata.samplePosition, table);
+                renderSegment (mono.get() + (position - start), metadata.samplePosition - position, table);
+                position = metadata.samplePosition;
+            }
+
+            const auto message = metadata.getMessage();
+            if (message.isNoteOn())
+                noteOn (message.getNoteNumber(), message.getFloatVelocity());
+            else if (message.isNoteOff())
+                noteOff (message.getNoteNumber());
+            else if (message.isAllNotesOff() || message.isAllSoundOff())
+                for (int v = 0; v < numVoices; ++v)
+                    voiceReleased[(size_t) v] = true;
+        }
+
+        if (position < blockEnd)
+        {
+            tables.getTableAt (blockEnd, table);
+            renderSegment (mono.get() + (position - start), blockEnd - position, table);
+        }
+
+        for (int ch = 0; ch < out.getNumChannels(); ++ch)
+            out.addFrom (ch, start, mono.get(), blockLength);
+    }
+}
+
+void AdditiveSynth::noteOn (int note, float velocity)
+{
+    // A repeated note restarts its own voice rather than stacking up
+    int voice = 0;
+    while (voice < numVoices && voiceNote[(size_t) voice] != note)
+        ++voice;
+
+    if (voice == numVoices)
+    {
+        if (numVoices == maxVoices)
+        {
+            // Steal the quietest voice
+            voice = 0;
+            for (int v = 1; v < numVoices; ++v)
+                if (voiceLevel[(size_t) v] < voiceLevel[(size_t) voice])
+                    voice = v;
+        }
+        else
+        {
+            voice = numVoices++;
+            voiceLevel[(size_t) voice] = 0.0f;
+
+            for (int p = 0; p < partialsPerVoice; ++p)
+                phase[voice * partialsPerVoice + p] = 0.0f;
+        }
+    }
+
+    voiceNote[(size_t) voice] = note;
+    voiceVelocity[(size_t) voice] = velocity;
+    voiceReleased[(size_t) voice] = false;
+
+    // Fundamental first, then harmonic i at (i + 2) times the fundamental.
+    // Partials at or above Nyquist stay silent.
+    const auto fundamental = juce::MidiMessage::getMidiNoteInHertz (note) / sampleRate;
+    for (int p = 0; p < partialsPerVoice; ++p)
+    {
+        const auto cycles = fundamental * (p + 1);
+        increment[voice * partialsPerVoice + p] = cycles < 0.5 ? static_cast<float> (cycles) : 0.0f;
+    }
+}
+
+void AdditiveSynth::noteOff (int note)
+{
+    for (int v = 0; v < numVoices; ++v)
+        if (voiceNote[(size_t) v] == note)
+            voiceReleased[(size_t) v] = true;
+}
+
+void AdditiveSynth::removeVoice (int voice)
+{
+    // The last voice moves into the gap so the partials stay contiguous
+    const int last = --numVoices;
+
+    if (voice != last)
+    {
+        voiceNote[(size_t) voice] = voiceNote[(size_t) last];
+        voiceVelocity[(size_t) voice] = voiceVelocity[(size_t) last];
+        voiceLevel[(size_t) voice] = voiceLevel[(size_t) last];
+        voiceReleased[(size_t) voice] = voiceReleased[(size_t) last];
+
+        const int to = voice * partialsPerVoice, from = last * partialsPerVoice;
+        juce::FloatVectorOperations::copy (phase.get() + to, phase.get() + from, partialsPerVoice);
+        juce::FloatVectorOperations::copy (increment.get() + to, increment.get() + from, partialsPerVoice);
+        juce::FloatVectorOperations::copy (amplitude.get() + to, amplitude.get() + from, partialsPerVoice);
+        juce::FloatVectorOperations::copy (amplitudeStep.get() + to, amplitudeStep.get() + from, partialsPerVoice);
+    }
+
+    const int freed = last * partialsPerVoice;
+    juce::FloatVectorOperations::clear (increment.get() + freed, partialsPerVoice);
+    juce::FloatVectorOperations::clear (amplitude.get() + freed, partialsPerVoice);
+    juce::FloatVectorOperations::clear (amplitudeStep.get() + freed, partialsPerVoice);
+}
+
+void AdditiveSynth::renderSegment (float* out, int numSamples, const HarmonicTable& table)
+{
+    // Envelopes move at control rate: each partial ramps linearly from its
+    // current amplitude to where the voice will be at the end of the segment
+    for (int v = numVoices; --v >= 0;)
+    {
+        auto& level = voiceLevel[(size_t) v];
+        level = voiceReleased[(size_t) v] ? juce::jmax (0.0f, level - releaseStep * (float) numSamples)
+                                           : juce::jmin (1.0f, level + attackStep * (float) numSamples);
+
+        const float voiceGain = gain * voiceVelocity[(size_t) v] * level;
+        float* amp = amplitude.get() + v * partialsPerVoice;
+        float* step = amplitudeStep.get() + v * partialsPerVoice;
+
+        for (int p = 0; p < partialsPerVoice; ++p)
+        {
+            const float strength = p == 0 ? 1.0f : table[(size_t) p - 1];
+            step[p] = (voiceGain * strength - amp[p]) / (float) numSamples;
+        }
+    }
+
+    const int numGroups = (numVoices * partialsPerVoice + laneWidth - 1) / laneWidth;
+    const int numChunks = (numGroups + groupsPerChunk - 1) / groupsPerChunk;
+
+    auto render = [this, numGroups, numSamples] (int chunk, int thread) {
+        renderChunk (chunk, numGroups, numSamples, thread);
+    };
+
+    if (numChunks > 1 && numGroups * laneWidth * numSamples >= parallelThreshold)
+        pool.run (numChunks, render);
+    else
+        for (int chunk = 0; chunk < numChunks; ++chunk)
+            render (chunk, 0);
+
+    for (int chunk = 0; chunk < numChunks; ++chunk)
+        juce::FloatVectorOperations::add (out, chunkOutput.get() + chunk * maxBlockSize, numSamples);
+
+    // Voices that have faded out free their partials
+    for (int v = numVoices; --v >= 0;)
+        if (voiceReleased[(size_t) v] && voiceLevel[(size_t) v] <= 0.0f)
+            removeVoice (v);
+}
+
+void AdditiveSynth::renderChunk (int chunk, int numGroups, int numSamples, int thread) noexcept
+{
+    float* laneSum = laneSums.get() + thread * maxBlockSize * laneWidth;
+    juce::FloatVectorOperations::clear (laneSum, numSamples * laneWidth);
+
+    const int lastGroup = juce::jmin (numGroups, (chunk + 1) * groupsPerChunk);
+    for (int group = chunk * groupsPerChunk; group < lastGroup; ++group)
+    {
+        const int first = group * laneWidth;
+        alignas (32) float ph[laneWidth], inc[laneWidth], amp[laneWidth], step[laneWidth];
+        std::copy_n (phase.get() + first, laneWidth, ph);
+        std::copy_n (increment.get() + first, laneWidth, inc);
+        std::copy_n (amplitude.get() + first, laneWidth, amp);
+        std::copy_n (amplitudeStep.get() + first, laneWidth, step);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float* sums = laneSum + i * laneWidth;
+
+            for (int lane = 0; lane < laneWidth; ++lane)
+            {
+                sums[lane] += amp[lane] * sine (ph[lane]);
+                amp[lane] += step[lane];
+                ph[lane] += inc[lane];
+                ph[lane] -= static_cast<float> (static_cast<int> (ph[lane]));
+            }
+        }
+
+        std::copy_n (ph, laneWidth, phase.get() + first);
+        std::copy_n (amp, laneWidth, amplitude.get() + first);
+    }
+
+    float* output = chunkOutput.get() + chunk * maxBlockSize;
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const float* sums = laneSum + i * laneWidth;
+        float sum = 0.0f;
+        for (int lane = 0; lane < laneWidth; ++lane)
+            sum += sums[lane];
+        output[i] = sum;
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "HarmonicTable.h"
+#include "TableCrossfader.h"
+#include "VoiceRenderPool.h"
+#include <juce_audio_basics/juce_audio_basics.h>
+
+// Additive sine synth for hearing the harmonic table without an external
+// synth: each note plays its fundamental plus one partial per harmonic,
+// weighted by the combo table.
+//
+// Voices and partials are kept as structure-of-arrays, packed so the active
+// partials are always contiguous. Rendering runs the partials in groups of
+// a fixed lane width with a branch-free polynomial sine, which compilers
+// turn into straight SIMD, and accumulates per lane so there is no
+// horizontal sum until the end of each segment.
+//
+// Big segments are split into chunks of partials, and the chunks are
+// rendered on a VoiceRenderPool. Each chunk has its own output, and the
+// outputs are mixed in chunk order, so the result is bit for bit the same
+// whatever the thread count. Small segments are rendered on the calling
+// thread, because waking the workers would cost more than it saves.
+//
+// prepare() and setNumThreads() allocate, render() is realtime safe.
+class AdditiveSynth
+{
+public:
+    static constexpr int maxVoices = 128;
+    static constexpr int partialsPerVoice = 1 + HarmonicSeries::numHarmonics;
+    static constexpr int laneWidth = 8;
+    static constexpr int groupsPerChunk = 8;
+
+    // Below this many partial-samples a segment is rendered on one thread
+    static constexpr int parallelThreshold = 16384;
+
+    void prepare (double sampleRate, int maxBlockSize);
+    void reset();
+
+    void setEnvelope (float attackSeconds, float releaseSeconds) noexcept;
+    void setGain (float newGain) noexcept { gain = newGain; }
+
+    // Not realtime safe, as it may start the shared worker threads
+    void setNumThreads (int numThreads) { pool.setNumThreads (numThreads); }
+    int getNumThreads() const noexcept { return pool.getNumThreads(); }
+
+    void setAudioWorkgroup (const juce::AudioWorkgroup& workgroup) { pool.setAudioWorkgroup (workgroup); }
+
+    // Adds the notes in midi to out, with the partial strengths following tables
+    void render (juce::AudioBuffer<float>& out, const juce::MidiBuffer& midi, const TableCrossfader& tables);
+
+    int getNumActiveVoices() const noexcept { return numVoices; }
+    int getNumActivePartials() const noexcept { return numVoices * partialsPerVoice; }
+
+    // sin (2 pi phase) for phase in [0, 1), good to about -100 dB
+    static float sine (float phase) noexcept
+    {
+        // Fold into the first quarter turn, where an odd polynomial is accurate
+        const float t = 0.5f - phase;                              // sin (2 pi t) == sin (2 pi phase)
+        const float a = std::abs (t);
+        const float x = juce::MathConstants<float>::twoPi * (0.25f - std::abs (a - 0.25f));
+        const float x2 = x * x;
+        const float y = x * (1.0f + x2 * (-1.0f / 6.0f + x2 * (1.0f / 120.0f + x2 * (-1.0f / 5040.0f + x2 * (1.0f / 362880.0f)))));
+        return std::copysign (y, t);
+    }
+
+private:
+    void noteOn (int note, float velocity);
+    void noteOff (int note);
+    void removeVoice (int voice);
+    void renderSegment (float* out, int numSamples, const HarmonicTable& table);
+    void renderChunk (int chunk, int numGroups, int numSamples, int thread) noexcept;
+
+    double sampleRate = 48000.0;
+    int maxBlockSize = 0;
+    float attackStep = 1.0f;
+    float releaseStep = 1.0f;
+    float gain = 0.2f;
+
+    // Voices, packed into [0, numVoices)
+    std::array<int, maxVoices> voiceNote {};
+    std::array<float, maxVoices> voiceVelocity {};
+    std::array<float, maxVoices> voiceLevel {};
+    std::array<bool, maxVoices> voiceReleased {};
+    int numVoices = 0;
+
+    // Partials, voice v owns [v * partialsPerVoice, (v + 1) * partialsPerVoice).
+    // Slots past the last active partial have zero amplitude and increment.
+    static constexpr int partialCapacity = (maxVoices * partialsPerVoice + laneWidth - 1) / laneWidth * laneWidth;
+    static constexpr int maxChunks = (partialCapacity / laneWidth + groupsPerChunk - 1) / groupsPerChunk;
+    juce::HeapBlock<float> phase;
+    juce::HeapBlock<float> increment;
+    juce::HeapBlock<float> amplitude;
+    juce::HeapBlock<float> amplitudeStep;
+
+    juce::HeapBlock<float> laneSums;    // maxBlockSize * laneWidth per thread
+    juce::HeapBlock<float> chunkOutput; // maxBlockSize per chunk
+    juce::HeapBlock<float> mono;
+
+    VoiceRenderPool pool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AdditiveSynth)
+};
@@ -0,0 +1,129 @@
+#include "BackgroundTasks.h"
+
+// The pool every BackgroundTasks shares, started on its first job
+struct BackgroundTasks::SharedPool
+{
+    juce::ThreadPool& get()
+    {
+        const juce::ScopedLock sl(lock);
+
+        if (pool == nullptr)
+            pool = std::make_unique<juce::ThreadPool>(juce::ThreadPoolOptions()
+                                                          .withThreadName("Background tasks")
+                                                          .withNumberOfThreads(getNumThreads()));
+
+        return *pool;
+    }
+
+    juce::CriticalSection lock;
+    std::unique_ptr<juce::ThreadPool> pool;
+};
+
+class BackgroundTasks::Job : public juce::ThreadPoolJob
+{
+public:
+    Job(const BackgroundTasks& jobOwner, std::function<void()> jobFunction)
+        : juce::ThreadPoolJob("Background task"), owner(jobOwner), function(std::move(jobFunction))
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        function();
+        return jobHasFinished;
+    }
+
+    const BackgroundTasks& owner;
+
+private:
+    std::function<void()> function;
+};
+
+//==============================================================================
+void BackgroundTasks::Batch::itemDone(bool written)
+{
+    if (written)
+        ++numWritten;
+
+    if (itemsLeft.fetch_sub(1) == 1)
+        finish();
+}
+
+void BackgroundTasks::Batch::finish()
+{
+    juce::MessageManager::callAsync([owner = owner, numWritten = numWritten.load(), onFinished = onFinished]() {
+        if (owner == nullptr)
+            return;
+
+        --owner->numBatchesRunning;
+        if (onFinished != nullptr)
+            onFinished(numWritten);
+    });
+}
+
+//==============================================================================
+BackgroundTasks::BackgroundTasks() = default;
+
+BackgroundTasks::~BackgroundTasks()
+{
+    stop();
+}
+
+void BackgroundTasks::addJob(std::function<void()> job)
+{
+    const juce::ScopedLock sl(lock);
+
+    // A running job may queue more while stop() waits for it
+    if (! stopped)
+        sharedPool->get().addJob(new Job(*this, std::move(job)), true);
+}
+
+void BackgroundTasks::stop()
+{
+    {
+        const juce::ScopedLock sl(lock);
+        if (stopped)
+            return;
+
+        stopped = true;
+    }
+
+    // Nothing was ever queued, so there's no need to start the pool to find that out
+    {
+        const juce::ScopedLock sl(sharedPool->lock);
+        if (sharedPool->pool == nullptr)
+            return;
+    }
+
+    struct OwnJobs : juce::ThreadPool::JobSelector
+    {
+        explicit OwnJobs(const BackgroundTasks& tasksOwner) : owner(tasksOwner) {}
+
+        bool isJobSuitable(juce::ThreadPoolJob* job) override
+        {
+            auto* task = dynamic_cast<Job*>(job);
+            return task != nullptr && &task->owner == &owner;
+        }
+
+        const BackgroundTasks& owner;
+    };
+
+    OwnJobs ownJobs(*this);
+    sharedPool->get().removeAllJobs(false, -1, &ownJobs);
+}
+
+int BackgroundTasks::getNumThreads()
+{
+    return juce::jmax(1, juce::SystemStats::getNumCpus() - 1);
+}
+
+void BackgroundTasks::initialiseBatch(Batch& batch, int numItems, std::function<void(int numWritten)> onFinished)
+{
+    batch.owner = this;
+    batch.onFinished = std::move(onFinished);
+    batch.itemsLeft = numItems;
+    ++numBatchesRunning;
+
+    if (numItems <= 0)
+        batch.finish();
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <juce_events/juce_events.h>
+
+// One owner's share of a process-wide juce::ThreadPool.
+//
+// Every preset library, preset navigator, wavetable exporter and sample
+// analyser in the process queues its work on the same pool, so a session
+// with a hundred instances still has one set of background threads. The pool's threads
+// only start when the first job is queued, and the pool goes with the last
+// BackgroundTasks.
+//
+// Jobs are tagged with their owner: stop() (and the destructor) drops the
+// owner's queued jobs, waits for its running ones and refuses new ones, so
+// an owner can go while others' jobs carry on. addJob() works from any
+// thread, including from inside a job.
+class BackgroundTasks
+{
+public:
+    // Tasks that end together, such as the files of an export. Owners can
+    // derive from it to keep the batch's shared state alongside.
+    class Batch
+    {
+    public:
+        virtual ~Batch() = default;
+
+        // Call once for every item of the batch, from any thread. The last
+        // call reports the batch finished on the message thread.
+        void itemDone(bool written);
+
+        int getNumWritten() const { return numWritten; }
+
+    private:
+        friend class BackgroundTasks;
+
+        void finish();
+
+        juce::WeakReference<BackgroundTasks> owner;
+        std::function<void(int numWritten)> onFinished;
+        std::atomic<int> itemsLeft { 0 };
+        std::atomic<int> numWritten { 0 };
+    };
+
+    BackgroundTasks();
+    ~BackgroundTasks();
+
+    void addJob(std::function<void()> job);
+    void stop();
+
+    // Threads the pool has once started, for splitting work into chunks
+    static int getNumThreads();
+
+    // A batch of numItems items. onFinished runs on the message thread with
+    // the number of items written, unless this owner has gone by then, and
+    // straight away (still asynchronously) for an empty batch.
+    template <typename BatchType = Batch>
+    std::shared_ptr<BatchType> startBatch(int numItems, std::function<void(int numWritten)> onFinished)
+    {
+        auto batch = std::make_shared<BatchType>();
+        initialiseBatch(*batch, numItems, std::move(onFinished));
+        return batch;
+    }
+
+    bool isRunningBatch() const { return numBatchesRunning > 0; }
+
+private:
+    struct SharedPool;
+    class Job;
+
+    void initialiseBatch(Batch& batch, int numItems, std::function<void(int numWritten)> onFinished);
+
+    juce::SharedResourcePointer<SharedPool> sharedPool;
+    juce::CriticalSection lock;
+    bool stopped = false;
+    std::atomic<int> numBatchesRunning { 0 };
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(BackgroundTasks)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BackgroundTasks)
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+
+// Thins out high-rate controller streams (poly pressure, continuous CCs,
+// channel pressure, pitch bend) to their last value in each block.
+// MPE controllers can send thousands of these per second, and poly pressure
+// is fanned out to every harmonic, so passing them all on multiplies traffic.
+//
+// Usage: scan() the block once, then ask isLatest() for each event in order.
+class ControllerDecimator
+{
+public:
+    ControllerDecimator() { lastOrdinal.fill (-1); }
+
+    void scan (const juce::MidiBuffer& midi) noexcept
+    {
+        int ordinal = 0;
+        for (const auto metadata : midi)
+        {
+            const auto key = streamKey (metadata.data, metadata.numBytes);
+            if (key >= 0)
+            {
+                if (lastOrdinal[(size_t) key] < 0)
+                    touched[(size_t) numTouched++] = static_cast<int16_t> (key);
+                else
+                    ++numSuperseded;
+
+                lastOrdinal[(size_t) key] = ordinal;
+            }
+            ++ordinal;
+        }
+    }
+
+    // True unless a later event in the scanned block supersedes this one.
+    // ordinal is the event's index within the block.
+    bool isLatest (const uint8_t* data, int numBytes, int ordinal) const noexcept
+    {
+        const auto key = streamKey (data, numBytes);
+        return key < 0 || lastOrdinal[(size_t) key] == ordinal;
+    }
+
+    // False when the scanned block has nothing to drop
+    bool hasSuperseded() const noexcept { return numSuperseded > 0; }
+
+    // Call after the block has been processed
+    void reset() noexcept
+    {
+        for (int i = 0; i < numTouched; ++i)
+            lastOrdinal[(size_t) touched[(size_t) i]] = -1;
+
+        numTouched = 0;
+        numSuperseded = 0;
+    }
+
+    // Bank select, data entry, (N)RPN, switch pedals and channel mode
+    // messages carry state, so every one of them must reach the synth.
+    static bool isContinuousController (int controller) noexcept
+    {
+        return controller != 0 && controller != 32
+            && controller != 6 && controller != 38
+            && ! (controller >= 64 && controller <= 69)
+            && ! (controller >= 96 && controller <= 101)
+            && controller < 120;
+    }
+
+private:
+    static constexpr int polyPressureKeys = 0;
+    static constexpr int controllerKeys = 16 * 128;
+    static constexpr int channelPressureKeys = 2 * 16 * 128;
+    static constexpr int pitchWheelKeys = channelPressureKeys + 16;
+    static constexpr int numKeys = pitchWheelKeys + 16;
+
+    static int streamKey (const uint8_t* data, int numBytes) noexcept
+    {
+        if (numBytes < 2)
+            return -1;
+
+        const int channel = data[0] & 0x0f;
+
+        switch (data[0] & 0xf0)
+        {
+            case 0xa0:
+                return numBytes >= 3 ? polyPressureKeys + channel * 128 + data[1] : -1;
+            case 0xb0:
+                return numBytes >= 3 && isContinuousController (data[1]) ? controllerKeys + channel * 128 + data[1] : -1;
+            case 0xd0:
+                return channelPressureKeys + channel;
+            case 0xe0:
+                return numBytes >= 3 ? pitchWheelKeys + channel : -1;
+            default:
+                return -1;
+        }
+    }
+
+    std::array<int, numKeys> lastOrdinal;
+    std::array<int16_t, numKeys> touched {};
+    int numTouched = 0;
+    int numSuperseded = 0;
+};
@@ -0,0 +1,151 @@
+#pragma once
+#include <juce_core/juce_core.h>
+
+// Undo/redo for table drawing and morph moves.
+//
+// Every edit is a compact delta (target, index, old, new) in a fixed ring
+// buffer, grouped into gestures: a whole mouse drag undoes as one step.
+// Repeated edits of the same value within a gesture collapse into one
+// record, so memory stays flat no matter how long a session runs.
+// When the ring fills up, the oldest gesture is forgotten.
+class EditHistory
+{
+public:
+    static constexpr int capacity = 4096;
+
+    // Targets 0 to 15 are morph bank slots
+    enum Target : int16_t
+    {
+        comboTarget = 16,
+        morphTarget,
+        morphXTarget,
+        morphYTarget
+    };
+
+    struct Delta
+    {
+        int16_t target = 0;
+        int16_t index = 0;
+        float oldValue = 0.0f;
+        float newValue = 0.0f;
+        uint32_t gesture = 0;
+    };
+
+    void beginGesture() noexcept
+    {
+        ++currentGesture;
+        gestureOpen = true;
+    }
+
+    void endGesture() noexcept { gestureOpen = false; }
+
+    void record(int target, int index, float oldValue, float newValue) noexcept
+    {
+        if (oldValue == newValue)
+            return;
+
+        const bool singleEdit = ! gestureOpen;
+        if (singleEdit)
+            beginGesture();
+
+        // Anything that could be redone is gone once something new happens
+        size = cursor;
+
+        if (auto* existing = findInCurrentGesture(target, index))
+        {
+            existing->newValue = newValue;
+        }
+        else
+        {
+            if (size == capacity)
+                dropOldestGesture();
+
+            at(size++) = { static_cast<int16_t>(target), static_cast<int16_t>(index), oldValue, newValue, currentGesture };
+            cursor = size;
+        }
+
+        if (singleEdit)
+            endGesture();
+    }
+
+    bool canUndo() const noexcept { return cursor > 0; }
+    bool canRedo() const noexcept { return cursor < size; }
+
+    // apply (target, index, value) is called for every delta of the gesture
+    template <typename ApplyFunction>
+    bool undo(ApplyFunction&& apply)
+    {
+        if (! canUndo())
+            return false;
+
+        gestureOpen = false;
+        const auto gesture = at(cursor - 1).gesture;
+
+        while (cursor > 0 && at(cursor - 1).gesture == gesture)
+        {
+            const auto& delta = at(--cursor);
+            apply(delta.target, delta.index, delta.oldValue);
+        }
+
+        return true;
+    }
+
+    template <typename ApplyFunction>
+    bool redo(ApplyFunction&& apply)
+    {
+        if (! canRedo())
+            return false;
+
+        gestureOpen = false;
+        const auto gesture = at(cursor).gesture;
+
+        while (cursor < size && at(cursor).gesture == gesture)
+        {
+            const auto& delta = at(cursor++);
+            apply(delta.target, delta.index, delta.newValue);
+        }
+
+        return true;
+    }
+
+    void clear() noexcept
+    {
+        start = size = cursor = 0;
+        gestureOpen = false;
+    }
+
+    int getNumDeltas() const noexcept { return size; }
+
+private:
+    Delta& at(int position) noexcept { return deltas[(size_t) ((start + position) % capacity)]; }
+
+    Delta* findInCurrentGesture(int target, int index) noexcept
+    {
+        for (int i = size - 1; i >= 0 && at(i).gesture == currentGesture; --i)
+            if (at(i).target == target && at(i).index == index)
+                return &at(i);
+
+        return nullptr;
+    }
+
+    void dropOldestGesture() noexcept
+    {
+        const auto gesture = at(0).gesture;
+
+        // A single gesture filling the whole ring just loses its oldest delta
+        do
+        {
+            start = (start + 1) % capacity;
+            --size;
+        } while (size > 0 && at(0).gesture == gesture && at(size - 1).gesture != gesture);
+
+        cursor = size;
+    }
+
+    std::array<Delta, capacity> deltas;
+    int start = 0;
+    int size = 0;
+    int cursor = 0;
+    uint32_t currentGesture = 0;
+    bool gestureOpen = false;
+};
@@ -1,9 +1,16 @@
 #include "Harm.h"
+#include "SampleAnalyser.h"
 
 void Harm::paint(juce::Graphics& g)
 {
     g.fillAll(getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId));
     drawRows(g);
+
+    if (isDropTarget)
+    {
+        g.setColour(barColour);
+        g.drawRect(getLocalBounds(), 2);
+    }
 }
 
 void Harm::drawRows(juce::Graphics& g)
@@ -73,6 +80,8 @@ void Harm::mouseDown(const juce::MouseEvent& e)
     if (getBarAtPosition(e.position.x) != -1)
     {
         isDragging = true;
+        if (onGestureStart != nullptr)
+            onGestureStart();
     }
 }
 
@@ -84,14 +93,48 @@ void Harm::mouseDrag(const juce::MouseEvent& e)
         if (barIndex != -1)
         {
             float newValue = valueFromY(e.position.y);
+            float oldValue = harmData[barIndex];
             harmData.set(barIndex, newValue);
+            if (onBarEdited != nullptr)
+                onBarEdited(barIndex, oldValue, newValue);
             DBG("Bar " << barIndex << " value: " << newValue);
             repaint();
+            if (onValueChange != nullptr)
+                onValueChange();
         }
     }
 }
 
 void Harm::mouseUp(const juce::MouseEvent& e)
 {
+    juce::ignoreUnused(e);
+    if (isDragging && onGestureEnd != nullptr)
+        onGestureEnd();
     isDragging = false;
 }
+
+bool Harm::isInterestedInFileDrag(const juce::StringArray& files)
+{
+    return onFileDropped != nullptr && files.size() == 1 && SampleAnalyser::isAudioFile(juce::File(files[0]));
+}
+
+void Harm::fileDragEnter(const juce::StringArray&, int, int)
+{
+    isDropTarget = true;
+    repaint();
+}
+
+void Harm::fileDragExit(const juce::StringArray&)
+{
+    isDropTarget = false;
+    repaint();
+}
+
+void Harm::filesDropped(const juce::StringArray& files, int, int)
+{
+    isDropTarget = false;
+    repaint();
+
+    if (onFileDropped != nullptr)
+        onFileDropped(juce::File(files[0]));
+}
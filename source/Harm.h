@@ -1,11 +1,13 @@
 #pragma once
 #include <juce_gui_basics/juce_gui_basics.h>
 #include <juce_audio_processors/juce_audio_processors.h>
+#include "HarmonicTable.h"
 
-class Harm : public juce::Component
+class Harm : public juce::Component,
+             public juce::FileDragAndDropTarget
 {
 public:
-    static constexpr int numValues = 8;
+    static constexpr int numValues = HarmonicSeries::numHarmonics;
     //==============================================================================
 
     Harm(juce::Colour barColor = juce::Colours::blue) : barColour(barColor)
@@ -35,6 +37,19 @@ public:
     // Add callback type definition
     std::function<void()> onValueChange;
 
+    // Drags are reported as one gesture of per-bar edits, for undo
+    std::function<void()> onGestureStart;
+    std::function<void()> onGestureEnd;
+    std::function<void(int index, float oldValue, float newValue)> onBarEdited;
+
+    // An audio file dropped onto the table, to fill it from
+    std::function<void(const juce::File& file)> onFileDropped;
+
+    bool isInterestedInFileDrag(const juce::StringArray& files) override;
+    void fileDragEnter(const juce::StringArray& files, int x, int y) override;
+    void fileDragExit(const juce::StringArray& files) override;
+    void filesDropped(const juce::StringArray& files, int x, int y) override;
+
     void setValue(int index, float value)
     {
         if (index >= 0 && index < numValues)
@@ -88,6 +103,7 @@ private:
 
     void drawRows(juce::Graphics& g);
     bool isDragging = false;
+    bool isDropTarget = false;
     float valueFromY(float y) const;
     int getBarAtPosition(float x);    // Add this line
     
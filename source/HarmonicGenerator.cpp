@@ -0,0 +1,389 @@
+#include "HarmonicGenerator.h"
+
+HarmonicGenerator::HarmonicGenerator()
+{
+    routing.fill (-1);
+    setRouting ({});
+}
+
+void HarmonicGenerator::setRouting (const Routing& newRouting) noexcept
+{
+    if (newRouting == routing)
+        return;
+
+    routing = newRouting;
+    mirrorChannels.fill (0);
+
+    for (size_t i = 0; i < routing.size(); ++i)
+    {
+        for (int channel = 1; channel <= HarmonicVoiceMap::numChannels; ++channel)
+        {
+            const auto output = (juce::uint8) (routing[i] > 0 ? juce::jmin (routing[i], 16) : channel);
+            outputChannels[i][(size_t) channel - 1] = output;
+
+            if (output != channel)
+                mirrorChannels[(size_t) channel - 1] |= (juce::uint16) (1u << (output - 1));
+        }
+    }
+}
+
+void HarmonicGenerator::prepare (int samplesPerBlock, int maxLookahead)
+{
+    // Events sit up to twice the lookahead ahead: latency plus the latest harmonic
+    maxLookaheadSamples = juce::jmax (0, maxLookahead);
+    lookaheadSamples = juce::jmin (lookaheadSamples, maxLookaheadSamples);
+    delayLine.prepare (2 * maxLookaheadSamples, samplesPerBlock, delayCapacity, sysexCapacity);
+
+    // Worst case for a dense block is a note-on per sample, each growing by
+    // 1 + numHarmonics events of up to 3 bytes plus the buffer's own header
+    output.ensureSize (static_cast<size_t> (juce::jmax (samplesPerBlock, 256))
+                       * (1 + HarmonicSeries::numHarmonics) * 12);
+    reset();
+}
+
+void HarmonicGenerator::reset()
+{
+    queue.clear();
+    voices.clear();
+    decimator.reset();
+    output.clear();
+    delayLine.reset();
+    routedInputChannels = 0;
+    pendingNoteOffs.fill (std::numeric_limits<juce::int64>::min());
+}
+
+//==============================================================================
+// The generic kernel reads every flag per event
+struct HarmonicGenerator::RuntimeMode
+{
+    bool decimate, lookahead, ump;
+    int numPartials;
+
+    static RuntimeMode make (const HarmonicGenerator& generator) noexcept
+    {
+        return { generator.decimateControllers, generator.lookaheadSamples > 0,
+                 generator.umpOutput != nullptr, HarmonicSeries::numHarmonics };
+    }
+};
+
+// A specialised kernel has them as constants, so the compiler drops the
+// unused branches and fully unrolls the partial loops
+template <int Index>
+struct HarmonicGenerator::KernelMode
+{
+    static constexpr bool decimate = (Index & 1) != 0;
+    static constexpr bool lookahead = (Index & 2) != 0;
+    static constexpr bool ump = (Index & 4) != 0;
+    static constexpr int numPartials = partialBuckets[(size_t) (Index >> 3)];
+
+    static KernelMode make (const HarmonicGenerator&) noexcept { return {}; }
+};
+
+namespace
+{
+    constexpr int getPartialBucket (int numPartials) noexcept
+    {
+        int bucket = 0;
+        while (HarmonicGenerator::partialBuckets[(size_t) bucket] < numPartials)
+            ++bucket;
+        return bucket;
+    }
+}
+
+template <typename Tables, int... Indices>
+constexpr auto HarmonicGenerator::makeKernels (std::integer_sequence<int, Indices...>) noexcept
+{
+    return std::array<void (HarmonicGenerator::*) (juce::MidiBuffer&, int, const Tables&), sizeof...(Indices)> {
+        &HarmonicGenerator::processEvents<KernelMode<Indices>, Tables>...
+    };
+}
+
+void HarmonicGenerator::process (juce::MidiBuffer& midi, const HarmonicTable& table, int numSamples)
+{
+    dispatch (midi, numSamples, FixedTable { table }, getNumActivePartials (table));
+}
+
+void HarmonicGenerator::process (juce::MidiBuffer& midi, const TableCrossfader& tables, int numSamples)
+{
+    dispatch (midi, numSamples, FadingTable { tables, eventTable }, tables.getNumActivePartials());
+}
+
+template <typename Tables>
+void HarmonicGenerator::dispatch (juce::MidiBuffer& midi, int numSamples, const Tables& tables, int numPartials)
+{
+    if (decimateControllers)
+        decimator.scan (midi);
+
+    // Most blocks carry only clock, controllers or nothing at all. With
+    // nothing to harmonise, copy, delay or thin out, midi goes on as it came in.
+    if (lookaheadSamples == 0 && delayLine.isEmpty() && ! decimator.hasSuperseded() && ! hasEventsToHandle (midi))
+    {
+        decimator.reset();
+        blockStart += numSamples;
+        return;
+    }
+
+    if (useGenericKernel)
+    {
+        processEvents<RuntimeMode> (midi, numSamples, tables);
+        return;
+    }
+
+    static constexpr auto kernels = makeKernels<Tables> (std::make_integer_sequence<int, 8 * (int) partialBuckets.size()>());
+
+    const int index = (decimateControllers ? 1 : 0)
+                    | (lookaheadSamples > 0 ? 2 : 0)
+                    | (umpOutput != nullptr ? 4 : 0)
+                    | getPartialBucket (numPartials) << 3;
+
+    (this->*kernels[(size_t) index]) (midi, numSamples, tables);
+}
+
+template <typename Mode, typename Tables>
+void HarmonicGenerator::processEvents (juce::MidiBuffer& midi, int numSamples, const Tables& tables)
+{
+    const auto mode = Mode::make (*this);
+    jassert (lookaheadSamples == 0 || numSamples > 0);
+
+    output.clear();
+    numEventsThisBlock = 0;
+
+    // Lookahead was just switched off: whatever is still waiting goes out now
+    if (! mode.lookahead && ! delayLine.isEmpty())
+        delayLine.flush (blockStart, output, umpOutput);
+
+    int ordinal = 0;
+    for (const auto metadata : midi)
+    {
+        if (mode.decimate && ! decimator.isLatest (metadata.data, metadata.numBytes, ordinal++))
+            continue;
+
+        const auto message = metadata.getMessage();
+        const auto time = metadata.samplePosition;
+
+        if (message.isNoteOn())
+        {
+            // A retriggered base note releases what it was holding first
+            stopHarmonics (mode, message.getChannel(), message.getNoteNumber(), time);
+            emit (mode, message, time);
+            startHarmonics (mode, message, time, tables.at (time));
+        }
+        else if (message.isNoteOff())
+        {
+            emit (mode, message, time);
+            stopHarmonics (mode, message.getChannel(), message.getNoteNumber(), time);
+        }
+        else if (message.isAftertouch())
+        {
+            emit (mode, message, time);
+            fanOutPressure (mode, message, time);
+        }
+        else if (message.isAllNotesOff() || message.isAllSoundOff())
+        {
+            for (int note = 0; note < HarmonicVoiceMap::numNotes; ++note)
+                stopHarmonics (mode, message.getChannel(), note, time);
+
+            emit (mode, message, time);
+        }
+        else
+        {
+            emit (mode, message, time);
+
+            if (isPerformanceMessage (metadata.data, metadata.numBytes))
+                mirrorToRoutedChannels (mode, message, time);
+        }
+    }
+
+    if (mode.decimate)
+        decimator.reset();
+
+    if (! delayLine.isEmpty())
+        delayLine.read (blockStart, numSamples, output, umpOutput);
+
+    blockStart += numSamples;
+    midi.swapWith (output);
+}
+
+bool HarmonicGenerator::hasEventsToHandle (const juce::MidiBuffer& midi) const noexcept
+{
+    for (const auto metadata : midi)
+    {
+        const auto status = metadata.data[0] & 0xf0;
+
+        // Note on/off, poly pressure, and all notes/sound off, which release harmonics
+        if ((status >= 0x80 && status <= 0xa0)
+            || (status == 0xb0 && metadata.numBytes >= 2 && (metadata.data[1] == 120 || metadata.data[1] == 123)))
+            return true;
+
+        // Performance controllers on a channel whose partials went elsewhere
+        if (isPerformanceMessage (metadata.data, metadata.numBytes) && getMirrorChannels (metadata.data) != 0)
+            return true;
+    }
+
+    return false;
+}
+
+template <typename Mode>
+void HarmonicGenerator::startHarmonics (const Mode& mode, const juce::MidiMessage& message, int time, const HarmonicTable& table)
+{
+    const int channel = message.getChannel();
+    const int baseNote = message.getNoteNumber();
+    const int baseVelocity = message.getVelocity();
+    auto& entry = voices.get (channel, baseNote);
+    const auto age = nextAge++;
+
+    for (int i = 0; i < mode.numPartials; ++i)
+    {
+        const float harmonicStrength = table[(size_t) i];
+        const int harmonicNote = baseNote + HarmonicSeries::semitoneOffsets[(size_t) i];
+
+        if (harmonicStrength <= 0.0f || harmonicNote > 127)
+            continue;
+
+        if (! hasEventBudget())
+            break;
+
+        bool dropped = false;
+        while (queue.size() >= maxVoices && ! dropped)
+        {
+            if (queue.shouldStealFor (harmonicStrength, age))
+                stealVoice (mode, time);
+            else
+                dropped = true;
+        }
+
+        if (dropped)
+            continue;
+
+        auto& voice = entry.voices[(size_t) i];
+        voice.channel = outputChannels[(size_t) i][(size_t) channel - 1];
+        voice.delay = harmonicDelay (mode, i);
+
+        if (voice.channel != channel)
+            routedInputChannels |= (juce::uint16) (1u << (channel - 1));
+
+        // Strum and humanize can pull a retriggered harmonic ahead of its own release
+        if (mode.lookahead)
+            voice.delay = delayAfterPendingOff (voice.channel, harmonicNote, time, voice.delay);
+
+        emitHarmonicOn (mode, voice.channel, baseNote, i, baseVelocity, harmonicStrength, time, voice.delay);
+
+        voice.note = harmonicNote;
+        voice.strength = harmonicStrength;
+        voice.age = age;
+        entry.activeMask |= 1u << i;
+        queue.push ({ &voice, channel, baseNote, i });
+    }
+}
+
+template <typename Mode>
+void HarmonicGenerator::stopHarmonics (const Mode& mode, int channel, int baseNote, int time)
+{
+    auto& entry = voices.get (channel, baseNote);
+
+    for (int i = 0; entry.activeMask != 0; ++i)
+    {
+        if (entry.isActive (i))
+        {
+            auto& voice = entry.voices[(size_t) i];
+            emitHarmonicOff (mode, voice.channel, voice.note, time, voice.delay);
+            queue.remove (voice);
+            entry.activeMask &= ~(1u << i);
+        }
+    }
+}
+
+template <typename Mode>
+void HarmonicGenerator::fanOutPressure (const Mode& mode, const juce::MidiMessage& message, int time)
+{
+    const int channel = message.getChannel();
+    const int pressure = message.getAfterTouchValue();
+    const auto& entry = voices.get (channel, message.getNoteNumber());
+
+    for (int i = 0; i < HarmonicSeries::numHarmonics; ++i)
+    {
+        if (entry.isActive (i) && hasEventBudget())
+        {
+            const auto& voice = entry.voices[(size_t) i];
+
+            if (mode.ump)
+            {
+                using namespace juce::universal_midi_packets;
+                const auto scaled = static_cast<juce::uint32> ((double) Conversion::scaleTo32 ((juce::uint8) pressure) * voice.strength);
+                emitPacket (mode, Factory::makePolyPressureV2 (0, (juce::uint8) (voice.channel - 1), (juce::uint8) voice.note, scaled), time, voice.delay);
+            }
+            else
+            {
+                const int scaled = juce::jlimit (0, 127, juce::roundToInt (pressure * voice.strength));
+                emit (mode, juce::MidiMessage::aftertouchChange (voice.channel, voice.note, scaled), time, voice.delay);
+            }
+        }
+    }
+}
+
+template <typename Mode>
+void HarmonicGenerator::stealVoice (const Mode& mode, int time)
+{
+    const auto victim = queue.top();
+
+    // The whole note goes, a note left with only some of its partials sounds like a different note
+    if (queue.getPolicy() == VoicePriorityQueue::Policy::oldestNote)
+    {
+        stopHarmonics (mode, victim.channel, victim.baseNote, time);
+        return;
+    }
+
+    emitHarmonicOff (mode, victim.voice->channel, victim.voice->note, time, victim.voice->delay);
+    voices.get (victim.channel, victim.baseNote).activeMask &= ~(1u << victim.harmonic);
+    queue.remove (*victim.voice);
+}
+
+template <typename Mode>
+void HarmonicGenerator::emitHarmonicOn (const Mode& mode, int channel, int baseNote, int harmonic, int baseVelocity, float strength, int time, int delay)
+{
+    const int note = baseNote + HarmonicSeries::semitoneOffsets[(size_t) harmonic];
+
+    if (! mode.ump)
+    {
+        const int velocity = juce::jlimit (1, 127, static_cast<int> (baseVelocity * strength));
+        emit (mode, juce::MidiMessage::noteOn (channel, note, static_cast<uint8_t> (velocity)), time, delay);
+        return;
+    }
+
+    // Full resolution velocity, so weak partials don't all land on 1, and
+    // the true pitch of harmonic (i + 2) rather than the nearest semitone
+    using namespace juce::universal_midi_packets;
+    const auto velocity = juce::jlimit (1, 0xffff, juce::roundToInt (Conversion::scaleTo16 ((juce::uint8) baseVelocity) * strength));
+    const auto pitch = (float) baseNote + 12.0f * std::log2 ((float) harmonic + 2.0f);
+    const auto pitch79 = juce::jlimit (0, 0xffff, juce::roundToInt (pitch * 512.0f));
+
+    emitPacket (mode, Factory::makeNoteOnV2 (0, (juce::uint8) (channel - 1), (juce::uint8) note, UmpBuffer::pitchAttribute,
+                                       (juce::uint16) velocity, (juce::uint16) pitch79),
+                time, delay);
+}
+
+template <typename Mode>
+void HarmonicGenerator::emitHarmonicOff (const Mode& mode, int channel, int note, int time, int delay)
+{
+    if (mode.lookahead)
+    {
+        auto& pending = pendingNoteOffs[(size_t) ((channel - 1) * 128 + note)];
+        pending = juce::jmax (pending, blockStart + time + lookaheadSamples + delay);
+    }
+
+    if (! mode.ump)
+        emit (mode, juce::MidiMessage::noteOff (channel, note), time, delay);
+    else
+        emitPacket (mode, juce::universal_midi_packets::Factory::makeNoteOffV2 (0, (juce::uint8) (channel - 1), (juce::uint8) note, 0, 0, 0), time, delay);
+}
+
+template <typename Mode>
+int HarmonicGenerator::harmonicDelay (const Mode& mode, int harmonic) noexcept
+{
+    if (! mode.lookahead)
+        return 0;
+
+    const float spread = strum * (float) (harmonic + 1) / (float) HarmonicSeries::numHarmonics;
+    const float jitter = humanize > 0.0f ? humanize * (random.nextFloat() * 2.0f - 1.0f) : 0.0f;
+    return juce::jlimit (-lookaheadSamples, lookaheadSamples, juce::roundToInt (spread + jitter));
+}
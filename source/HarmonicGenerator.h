@@ -0,0 +1,246 @@
+#pragma once
+#include "ControllerDecimator.h"
+#include "HarmonicTable.h"
+#include "HarmonicVoiceMap.h"
+#include "MidiDelayLine.h"
+#include "TableCrossfader.h"
+#include "VoicePriorityQueue.h"
+#include <juce_audio_basics/juce_audio_basics.h>
+
+// Turns incoming base notes into base + harmonic notes, and fans per-note
+// expression (poly aftertouch) out to every harmonic a base note is holding.
+// Runs on the audio thread: prepare() reserves everything process() needs.
+//
+// Output is bounded: at most maxVoices harmonics sound at once (the queue's
+// policy decides who gets stolen) and generated events stop once a block
+// holds maxEventsPerBlock events. Incoming events and note-offs always pass,
+// and so do the copies of channel-wide messages sent to routed channels.
+//
+// In lookahead mode everything is delayed by the reported latency, which
+// leaves room to place each harmonic up to that far before or after its
+// base note (strum and humanize) while the base note stays on the beat.
+//
+// With a UMP output set, the generated harmonic events are written there as
+// MIDI 2.0 packets instead: note-ons carry a 16-bit velocity and the
+// harmonic's exact pitch, pressure is 32-bit. Everything else stays MIDI 1.0.
+//
+// The event loop is a template over the mode flags (controller decimation,
+// lookahead, UMP output) and the number of partials the table uses. Every
+// combination is compiled up front and process() picks one from a table
+// once per block, so the per-event code has no mode branches left in it.
+class HarmonicGenerator
+{
+public:
+    // Kernels are compiled for tables using up to this many leading partials
+    static constexpr std::array<int, 3> partialBuckets { 2, 4, HarmonicSeries::numHarmonics };
+
+    // Events in flight in lookahead mode, beyond this they go out undelayed
+    static constexpr int delayCapacity = 8192;
+
+    // Bytes of sysex in flight in lookahead mode, likewise
+    static constexpr int sysexCapacity = 16384;
+
+    HarmonicGenerator();
+
+    void prepare (int samplesPerBlock, int maxLookaheadSamples = 0);
+    void reset();
+
+    void setDecimateControllers (bool shouldDecimate) noexcept { decimateControllers = shouldDecimate; }
+    void setStealPolicy (VoicePriorityQueue::Policy policy) noexcept { queue.setPolicy (policy); }
+    void setLimits (int newMaxVoices, int newMaxEventsPerBlock) noexcept
+    {
+        maxVoices = juce::jlimit (1, VoicePriorityQueue::capacity, newMaxVoices);
+        maxEventsPerBlock = juce::jmax (1, newMaxEventsPerBlock);
+    }
+
+    // latencySamples of 0 turns lookahead off. strum spreads harmonic i by
+    // strum * (i + 1) / numHarmonics, humanize adds up to +/- that much at random
+    void setLookahead (int latencySamples, float strumSamples, float humanizeSamples) noexcept
+    {
+        lookaheadSamples = juce::jlimit (0, maxLookaheadSamples, latencySamples);
+        strum = strumSamples;
+        humanize = humanizeSamples;
+    }
+
+    // Harmonic events are added to buffer as MIDI 2.0 packets, or go out as
+    // MIDI 1.0 when it's null. The caller clears the buffer between blocks.
+    void setUmpOutput (UmpBuffer* buffer) noexcept { umpOutput = buffer; }
+
+    // Output channel for each partial: 0 keeps the base note's channel,
+    // 1-16 sends that partial to a fixed channel, so a multi-timbral rig can
+    // give each group of partials its own synth. Compiled into a
+    // [partial][input channel] lookup, and only when it actually changes.
+    // Controllers, pitch bend, channel pressure and program changes are
+    // copied to every channel an input channel's partials are routed to, so
+    // the synths there hear the same sustain pedal and bends as the base note.
+    using Routing = std::array<int, HarmonicSeries::numHarmonics>;
+    void setRouting (const Routing& newRouting) noexcept;
+
+    int getNumActiveVoices() const noexcept { return queue.size(); }
+
+    // Replaces the contents of midi with the generated output. A block with
+    // no note events and nothing pending is left as it is, without a copy.
+    // numSamples is only needed in lookahead mode.
+    void process (juce::MidiBuffer& midi, const HarmonicTable& table, int numSamples = 0);
+
+    // Same, with each note-on taking the crossfader's table at its sample position.
+    // Held notes keep the harmonics they started with until released.
+    void process (juce::MidiBuffer& midi, const TableCrossfader& tables, int numSamples = 0);
+
+    // Runs the one loop that checks every mode flag per event instead of a
+    // specialised kernel. The output is the same, this is for comparison.
+    void setUseGenericKernel (bool shouldUseGeneric) noexcept { useGenericKernel = shouldUseGeneric; }
+
+private:
+    // Where note-ons get their table from
+    struct FixedTable
+    {
+        const HarmonicTable& table;
+        const HarmonicTable& at (int) const noexcept { return table; }
+    };
+
+    struct FadingTable
+    {
+        const TableCrossfader& tables;
+        HarmonicTable& scratch;
+        const HarmonicTable& at (int time) const noexcept
+        {
+            tables.getTableAt (time, scratch);
+            return scratch;
+        }
+    };
+
+    struct RuntimeMode;
+    template <int Index>
+    struct KernelMode;
+
+    template <typename Tables, int... Indices>
+    static constexpr auto makeKernels (std::integer_sequence<int, Indices...>) noexcept;
+
+    template <typename Tables>
+    void dispatch (juce::MidiBuffer& midi, int numSamples, const Tables& tables, int numPartials);
+
+    template <typename Mode, typename Tables>
+    void processEvents (juce::MidiBuffer& midi, int numSamples, const Tables& tables);
+
+    template <typename Mode>
+    int harmonicDelay (const Mode& mode, int harmonic) noexcept;
+
+    template <typename Mode>
+    void startHarmonics (const Mode& mode, const juce::MidiMessage& message, int time, const HarmonicTable& table);
+    template <typename Mode>
+    void stopHarmonics (const Mode& mode, int channel, int baseNote, int time);
+    template <typename Mode>
+    void fanOutPressure (const Mode& mode, const juce::MidiMessage& message, int time);
+    template <typename Mode>
+    void stealVoice (const Mode& mode, int time);
+
+    template <typename Mode>
+    void emitHarmonicOn (const Mode& mode, int channel, int baseNote, int harmonic, int baseVelocity, float strength, int time, int delay);
+    template <typename Mode>
+    void emitHarmonicOff (const Mode& mode, int channel, int note, int time, int delay);
+
+    // The delay that keeps a harmonic note-on from landing before a note-off
+    // still pending on the same key, which would cut the new note short
+    int delayAfterPendingOff (int channel, int note, int time, int delay) const noexcept
+    {
+        const auto due = blockStart + time + lookaheadSamples + delay;
+        const auto off = pendingNoteOffs[(size_t) ((channel - 1) * 128 + note)];
+        return off > due ? delay + (int) (off - due) : delay;
+    }
+
+    template <typename Mode>
+    void emit (const Mode& mode, const juce::MidiMessage& message, int time, int delay = 0)
+    {
+        // A full delay line sends the event on undelayed rather than losing it
+        if (! mode.lookahead
+            || ! delayLine.add (message.getRawData(), message.getRawDataSize(), blockStart + time + lookaheadSamples + delay, blockStart))
+            output.addEvent (message, time);
+
+        ++numEventsThisBlock;
+    }
+
+    template <typename Mode>
+    void emitPacket (const Mode& mode, const juce::universal_midi_packets::PacketX2& packet, int time, int delay)
+    {
+        const bool delayed = mode.lookahead
+                          && delayLine.addPacket (packet.data(), blockStart + time + lookaheadSamples + delay, blockStart);
+
+        // A full UMP buffer falls back to MIDI 1.0 rather than losing the event
+        if (! delayed && ! umpOutput->add (packet, time))
+            UmpBuffer::addAsMidi1 (packet.data(), time, output);
+
+        ++numEventsThisBlock;
+    }
+
+    // Pitch bend, channel pressure, and the controllers that shape notes
+    // already sounding: mod wheel, expression, sustain, sostenuto and soft
+    // pedal. Program and bank changes and channel mode messages stay put.
+    static bool isPerformanceMessage (const juce::uint8* data, int numBytes) noexcept
+    {
+        const auto status = data[0] & 0xf0;
+        if (status == 0xd0 || status == 0xe0)
+            return true;
+
+        if (status != 0xb0 || numBytes < 2)
+            return false;
+
+        const auto controller = data[1];
+        return controller == 1 || controller == 11 || controller == 64 || controller == 66 || controller == 67;
+    }
+
+    // Only channels whose notes have sent harmonics elsewhere are mirrored
+    juce::uint16 getMirrorChannels (const juce::uint8* data) const noexcept
+    {
+        const auto channel = (size_t) (data[0] & 0x0f);
+        return ((routedInputChannels >> channel) & 1u) != 0 ? mirrorChannels[channel] : 0;
+    }
+
+    template <typename Mode>
+    void mirrorToRoutedChannels (const Mode& mode, const juce::MidiMessage& message, int time)
+    {
+        const auto channels = getMirrorChannels (message.getRawData());
+
+        for (int channel = 1; channel <= HarmonicVoiceMap::numChannels; ++channel)
+        {
+            if ((channels >> (channel - 1)) & 1u)
+            {
+                auto copy = message;
+                copy.setChannel (channel);
+                emit (mode, copy, time);
+            }
+        }
+    }
+
+    bool hasEventsToHandle (const juce::MidiBuffer& midi) const noexcept;
+
+    bool hasEventBudget() const noexcept { return numEventsThisBlock < maxEventsPerBlock; }
+
+    HarmonicVoiceMap voices;
+    VoicePriorityQueue queue;
+    ControllerDecimator decimator;
+    juce::MidiBuffer output;
+    UmpBuffer* umpOutput = nullptr;
+    HarmonicTable eventTable {};
+    Routing routing {};
+    std::array<std::array<juce::uint8, HarmonicVoiceMap::numChannels>, HarmonicSeries::numHarmonics> outputChannels;
+    std::array<juce::uint16, HarmonicVoiceMap::numChannels> mirrorChannels {}; // per input channel, one bit per other output channel
+    juce::uint16 routedInputChannels = 0; // input channels that have started a harmonic on another channel since reset()
+    bool decimateControllers = false;
+    bool useGenericKernel = false;
+    int maxVoices = VoicePriorityQueue::capacity;
+    int maxEventsPerBlock = 4096;
+    int numEventsThisBlock = 0;
+    uint32_t nextAge = 0;
+
+    MidiDelayLine delayLine;
+    std::array<juce::int64, HarmonicVoiceMap::numChannels * 128> pendingNoteOffs; // latest delayed note-off per output key
+    juce::Random random;
+    juce::int64 blockStart = 0;
+    int maxLookaheadSamples = 0;
+    int lookaheadSamples = 0;
+    float strum = 0.0f;
+    float humanize = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HarmonicGenerator)
+};
@@ -0,0 +1,23 @@
+#pragma once
+#include <array>
+
+// Every harmonic table holds one strength per generated partial.
+// Index i is the (i + 2)th harmonic of the base note, so index 0 is the octave.
+struct HarmonicSeries
+{
+    static constexpr int numHarmonics = 8;
+
+    // Semitones above the base note for each harmonic, i.e. round (12 * log2 (i + 2))
+    static constexpr std::array<int, numHarmonics> semitoneOffsets { 12, 19, 24, 28, 31, 34, 36, 38 };
+};
+
+using HarmonicTable = std::array<float, HarmonicSeries::numHarmonics>;
+
+// How many leading partials it takes to cover every non-zero strength
+inline int getNumActivePartials (const HarmonicTable& table) noexcept
+{
+    int count = HarmonicSeries::numHarmonics;
+    while (count > 0 && table[static_cast<std::size_t> (count - 1)] <= 0.0f)
+        --count;
+    return count;
+}
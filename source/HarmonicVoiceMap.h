@@ -0,0 +1,47 @@
+#pragma once
+#include "HarmonicTable.h"
+#include <juce_core/juce_core.h>
+
+// Remembers which harmonics every sounding base note generated, so that
+// note-offs and per-note expression can be fanned out to exactly those
+// harmonics in O(1), regardless of what the table looks like by then.
+class HarmonicVoiceMap
+{
+public:
+    static constexpr int numChannels = 16;
+    static constexpr int numNotes = 128;
+
+    struct Voice
+    {
+        int note = 0;
+        int channel = 1;     // output channel, which routing may have moved off the base note's
+        float strength = 0.0f;
+        uint32_t age = 0;   // start order of its base note, for voice stealing
+        int queueIndex = -1; // position in the VoicePriorityQueue while sounding
+        int delay = 0;       // lookahead offset in samples, note-off and expression follow it
+    };
+
+    struct Entry
+    {
+        uint32_t activeMask = 0; // bit i is set while harmonic i is sounding
+        std::array<Voice, HarmonicSeries::numHarmonics> voices;
+
+        bool isActive (int harmonic) const noexcept { return (activeMask & (1u << harmonic)) != 0; }
+    };
+
+    // channel is 1-16, like juce::MidiMessage::getChannel()
+    Entry& get (int channel, int baseNote) noexcept
+    {
+        jassert (channel >= 1 && channel <= numChannels && juce::isPositiveAndBelow (baseNote, numNotes));
+        return entries[static_cast<size_t> ((channel - 1) * numNotes + baseNote)];
+    }
+
+    void clear() noexcept
+    {
+        for (auto& entry : entries)
+            entry.activeMask = 0;
+    }
+
+private:
+    std::array<Entry, numChannels * numNotes> entries;
+};
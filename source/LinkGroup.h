@@ -0,0 +1,217 @@
+#pragma once
+#include "SharedSnapshot.h"
+#include "TableBank.h"
+#include <juce_events/juce_events.h>
+#include <map>
+
+// The tables an instance plays, as the message thread publishes them
+struct PublishedTables
+{
+    TableBank::State bank;
+    HarmonicTable combo {};
+    uint32_t bankVersion = 0;
+    uint32_t comboVersion = 0;
+    uint32_t transitionVersion = 0;
+};
+
+// Instances in one process that play the same tables and morph, so a
+// template with the plugin on many tracks is edited in one place.
+//
+// A group's tables are one SharedSnapshot. An edit in any member's editor
+// publishes it once, and every member's audio thread reads that copy in
+// place: nothing is copied per member and nothing locks. The morph is a
+// handful of atomics, written by whichever member's morph parameters move.
+//
+// Members join by name and the group goes when its last member leaves.
+// join(), leave(), publish() and collectGarbage() lock, as a host may
+// restore a session (and so join) off the message thread, and each member
+// publishes from its own. A publish only stores the tables and flags the
+// other members, which then read the group on their own message thread,
+// so no member's state is touched from another's thread. A member that has
+// left hears nothing more. read() and the morph don't lock and work
+// anywhere.
+class LinkGroup
+{
+public:
+    struct Listener
+    {
+        virtual ~Listener() = default;
+
+        // On the member's message thread, some time after other members
+        // published. The flags add up every publish since the last call,
+        // and read() has the latest tables
+        virtual void linkedTablesChanged(bool bankChanged, bool comboChanged) = 0;
+
+        // Delivers a pending change now, on the calling thread
+        void handleLinkedChangesNow() { delivery.handleUpdateNowIfNeeded(); }
+
+    private:
+        friend class LinkGroup;
+
+        struct Delivery final : public juce::AsyncUpdater
+        {
+            explicit Delivery(Listener& owner) : listener(owner) {}
+            ~Delivery() override { cancelPendingUpdate(); }
+
+            void post(int changes)
+            {
+                pending.fetch_or(changes);
+                triggerAsyncUpdate();
+            }
+
+            void cancel()
+            {
+                cancelPendingUpdate();
+                pending.store(0);
+            }
+
+            void handleAsyncUpdate() override
+            {
+                if (const int changes = pending.exchange(0); changes != 0)
+                    listener.linkedTablesChanged((changes & bankChange) != 0, (changes & comboChange) != 0);
+            }
+
+            Listener& listener;
+            std::atomic<int> pending { 0 };
+        };
+
+        static constexpr int bankChange = 1, comboChange = 2;
+        Delivery delivery { *this };
+    };
+
+    // The group called name, started with initialTables and initialMorph if nobody is in it
+    static std::shared_ptr<LinkGroup> join(const juce::String& name, Listener& member,
+                                           const PublishedTables& initialTables, const TableBank::MorphParameters& initialMorph)
+    {
+        auto& registry = getRegistry();
+        const juce::ScopedLock sl(registry.lock);
+        auto group = registry.groups[name].lock();
+
+        if (group == nullptr)
+        {
+            group.reset(new LinkGroup(name, ++registry.lastId, initialTables));
+            group->setMorph(initialMorph);
+            registry.groups[name] = group;
+        }
+
+        const juce::ScopedLock ml(group->membersLock);
+        group->members.add(&member);
+        return group;
+    }
+
+    void leave(Listener& member)
+    {
+        // In this order, so a join can't slip in between the last member
+        // leaving and the group coming off the registry
+        auto& registry = getRegistry();
+        const juce::ScopedLock sl(registry.lock);
+        const juce::ScopedLock ml(membersLock);
+        members.removeFirstMatchingValue(&member);
+        member.delivery.cancel();
+
+        if (members.isEmpty())
+            registry.groups.erase(name);
+    }
+
+    const juce::String& getName() const noexcept { return name; }
+    uint32_t getId() const noexcept { return id; }
+
+    int getNumMembers() const
+    {
+        const juce::ScopedLock ml(membersLock);
+        return members.size();
+    }
+
+    // Replaces the tables, bumping the versions of what changed, and flags
+    // every member but from
+    void publish(const TableBank::State& bank, const HarmonicTable& combo, bool bankChanged, bool comboChanged, bool transition, Listener* from)
+    {
+        // Held until the members are flagged, so none of them can leave and go meanwhile
+        const juce::ScopedLock ml(membersLock);
+
+        auto tables = std::make_unique<PublishedTables>();
+        tables->bank = bank;
+        tables->combo = combo;
+        tables->bankVersion = bankVersion += bankChanged ? 1 : 0;
+        tables->comboVersion = comboVersion += comboChanged ? 1 : 0;
+        tables->transitionVersion = transitionVersion += transition ? 1 : 0;
+
+        snapshot.publish(std::move(tables));
+
+        const int changes = (bankChanged ? Listener::bankChange : 0) | (comboChanged ? Listener::comboChange : 0);
+        if (changes != 0)
+            for (auto* member : members)
+                if (member != from)
+                    member->delivery.post(changes);
+    }
+
+    // Calls reader (const PublishedTables&) on the current tables
+    template <typename Reader>
+    auto read(Reader&& reader) const
+    {
+        return snapshot.read(std::forward<Reader>(reader));
+    }
+
+    // Retired tables go once no audio thread is reading them, this retries
+    void collectGarbage()
+    {
+        const juce::ScopedLock ml(membersLock);
+        snapshot.collectGarbage();
+    }
+
+    void setMorph(const TableBank::MorphParameters& params) noexcept
+    {
+        morphMode.store(static_cast<int>(params.mode), std::memory_order_relaxed);
+        morphCurve.store(static_cast<int>(params.curve), std::memory_order_relaxed);
+        morph.store(params.morph, std::memory_order_relaxed);
+        morphX.store(params.x, std::memory_order_relaxed);
+        morphY.store(params.y, std::memory_order_relaxed);
+    }
+
+    TableBank::MorphParameters getMorph() const noexcept
+    {
+        return { static_cast<TableBank::MorphMode>(morphMode.load(std::memory_order_relaxed)),
+                 static_cast<MorphEngine::Curve>(morphCurve.load(std::memory_order_relaxed)),
+                 morph.load(std::memory_order_relaxed),
+                 morphX.load(std::memory_order_relaxed),
+                 morphY.load(std::memory_order_relaxed) };
+    }
+
+private:
+    struct Registry
+    {
+        juce::CriticalSection lock;
+        std::map<juce::String, std::weak_ptr<LinkGroup>> groups;
+        uint32_t lastId = 0;
+    };
+
+    // The group counts versions from zero, whatever the first member had reached
+    LinkGroup(const juce::String& groupName, uint32_t groupId, const PublishedTables& initialTables)
+        : name(groupName), id(groupId), snapshot(std::make_unique<const PublishedTables>(PublishedTables { initialTables.bank, initialTables.combo }))
+    {
+    }
+
+    static Registry& getRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    const juce::String name;
+    const uint32_t id;
+    SharedSnapshot<PublishedTables> snapshot;
+    juce::CriticalSection membersLock; // Also makes the snapshot's writers take turns
+    juce::Array<Listener*> members;
+    uint32_t bankVersion = 0;
+    uint32_t comboVersion = 0;
+    uint32_t transitionVersion = 0;
+
+    // Each is atomic on its own: a reader may mix two writers' values for a block
+    std::atomic<int> morphMode { 0 };
+    std::atomic<int> morphCurve { 0 };
+    std::atomic<float> morph { 0.5f };
+    std::atomic<float> morphX { 0.5f };
+    std::atomic<float> morphY { 0.5f };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LinkGroup)
+};
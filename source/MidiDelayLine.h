@@ -0,0 +1,220 @@
+#pragma once
+#include "UmpBuffer.h"
+
+// Fixed-capacity delay line for MIDI messages and MIDI 2.0 packets, keyed
+// by absolute sample time.
+//
+// A timing wheel: one bucket per sample, each a linked list threaded
+// through a preallocated pool of events. Adding is O(1) (append to the
+// bucket for that sample) and a block is read back in time order, keeping
+// insertion order within a sample. prepare() allocates, nothing else does.
+//
+// Messages longer than three bytes (sysex) keep their bytes in a ring of
+// their own, which they must enter in time order. Pass-through messages
+// all wait the same latency, so they do.
+class MidiDelayLine
+{
+public:
+    // maxDelay is the furthest ahead add() may schedule, relative to the
+    // start of the block being read. longBytes is the room for sysex.
+    void prepare (int maxDelay, int maxBlockSize, int capacity, int longBytes = 0)
+    {
+        const auto wheelSize = juce::nextPowerOfTwo (maxDelay + maxBlockSize + 1);
+        buckets.assign ((size_t) wheelSize, {});
+        wheelMask = wheelSize - 1;
+        horizon = wheelSize - 1;
+
+        events.resize ((size_t) capacity);
+        longData.resize ((size_t) longBytes);
+        longScratch.resize ((size_t) longBytes);
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& bucket : buckets)
+            bucket = {};
+
+        for (size_t i = 0; i < events.size(); ++i)
+            events[i].next = i + 1 < events.size() ? (int) i + 1 : -1;
+
+        freeList = events.empty() ? -1 : 0;
+        numPending = 0;
+        longRead = longWrite = longUsed = 0;
+    }
+
+    bool isEmpty() const noexcept { return numPending == 0; }
+
+    // Returns false when the pool (or for sysex, its ring) is full or time
+    // is beyond the wheel, in which case the caller should deliver the
+    // message straight away
+    bool add (const juce::uint8* data, int numBytes, juce::int64 time, juce::int64 blockStart) noexcept
+    {
+        if (freeList < 0 || numBytes < 1 || time < blockStart || time - blockStart > horizon)
+            return false;
+
+        const bool isLong = numBytes > 3;
+        if (isLong && ! writeLong (data, (size_t) numBytes))
+            return false;
+
+        const int index = freeList;
+        auto& event = events[(size_t) index];
+        freeList = event.next;
+
+        if (! isLong)
+            std::copy (data, data + numBytes, event.data.begin());
+
+        event.numBytes = numBytes;
+        event.kind = isLong ? Kind::longMessage : Kind::shortMessage;
+        schedule (index, time);
+        return true;
+    }
+
+    // Same for a 64-bit Universal MIDI Packet, which read() hands to a UmpBuffer
+    bool addPacket (const juce::uint32* packet, juce::int64 time, juce::int64 blockStart) noexcept
+    {
+        if (freeList < 0 || time < blockStart || time - blockStart > horizon)
+            return false;
+
+        const int index = freeList;
+        auto& event = events[(size_t) index];
+        freeList = event.next;
+
+        std::memcpy (event.data.data(), packet, sizeof (juce::uint32) * UmpBuffer::wordsPerPacket);
+        event.numBytes = (int) (sizeof (juce::uint32) * UmpBuffer::wordsPerPacket);
+        event.kind = Kind::packet;
+        schedule (index, time);
+        return true;
+    }
+
+    // Moves everything due in [blockStart, blockStart + numSamples) into out.
+    // Packets go to packets, or are converted to MIDI 1.0 when that's null.
+    void read (juce::int64 blockStart, int numSamples, juce::MidiBuffer& out, UmpBuffer* packets = nullptr) noexcept
+    {
+        for (int offset = 0; offset < numSamples && numPending > 0; ++offset)
+            drainBucket ((size_t) ((blockStart + offset) & wheelMask), offset, out, packets);
+    }
+
+    // Delivers everything still pending at the start of the block, in time order
+    void flush (juce::int64 blockStart, juce::MidiBuffer& out, UmpBuffer* packets = nullptr) noexcept
+    {
+        for (int offset = 0; offset <= horizon && numPending > 0; ++offset)
+            drainBucket ((size_t) ((blockStart + offset) & wheelMask), 0, out, packets);
+    }
+
+private:
+    enum class Kind : juce::uint8
+    {
+        shortMessage,
+        longMessage,
+        packet
+    };
+
+    struct Event
+    {
+        std::array<juce::uint8, 8> data {}; // MIDI bytes, or the words of a packet. Sysex is in longData
+        int numBytes = 0;
+        Kind kind = Kind::shortMessage;
+        juce::int64 time = 0;
+        int next = -1;
+    };
+
+    struct Bucket
+    {
+        int head = -1;
+        int tail = -1;
+    };
+
+    void schedule (int index, juce::int64 time) noexcept
+    {
+        auto& event = events[(size_t) index];
+        event.time = time;
+        event.next = -1;
+
+        auto& bucket = buckets[(size_t) (time & wheelMask)];
+        if (bucket.tail >= 0)
+            events[(size_t) bucket.tail].next = index;
+        else
+            bucket.head = index;
+
+        bucket.tail = index;
+        ++numPending;
+    }
+
+    void drainBucket (size_t bucketIndex, int samplePosition, juce::MidiBuffer& out, UmpBuffer* packets) noexcept
+    {
+        auto& bucket = buckets[bucketIndex];
+
+        for (int index = bucket.head; index >= 0;)
+        {
+            auto& event = events[(size_t) index];
+            const int next = event.next;
+
+            if (event.kind == Kind::shortMessage)
+            {
+                out.addEvent (event.data.data(), event.numBytes, samplePosition);
+            }
+            else if (event.kind == Kind::longMessage)
+            {
+                out.addEvent (readLong ((size_t) event.numBytes), event.numBytes, samplePosition);
+            }
+            else
+            {
+                juce::uint32 packet[UmpBuffer::wordsPerPacket];
+                std::memcpy (packet, event.data.data(), sizeof (packet));
+
+                if (packets == nullptr || ! packets->add (packet, samplePosition))
+                    UmpBuffer::addAsMidi1 (packet, samplePosition, out);
+            }
+
+            event.next = freeList;
+            freeList = index;
+            --numPending;
+            index = next;
+        }
+
+        bucket = {};
+    }
+
+    bool writeLong (const juce::uint8* data, size_t numBytes) noexcept
+    {
+        if (numBytes > longData.size() - longUsed)
+            return false;
+
+        const auto first = juce::jmin (numBytes, longData.size() - longWrite);
+        std::copy (data, data + first, longData.begin() + (std::ptrdiff_t) longWrite);
+        std::copy (data + first, data + numBytes, longData.begin());
+
+        longWrite = (longWrite + numBytes) % longData.size();
+        longUsed += numBytes;
+        return true;
+    }
+
+    // The oldest message in the ring, valid until the next writeLong()
+    const juce::uint8* readLong (size_t numBytes) noexcept
+    {
+        const auto* result = longData.data() + longRead;
+        const auto first = longData.size() - longRead;
+
+        // One that wraps around the end is put back together first
+        if (numBytes > first)
+        {
+            std::copy (longData.begin() + (std::ptrdiff_t) longRead, longData.end(), longScratch.begin());
+            std::copy (longData.begin(), longData.begin() + (std::ptrdiff_t) (numBytes - first), longScratch.begin() + (std::ptrdiff_t) first);
+            result = longScratch.data();
+        }
+
+        longRead = (longRead + numBytes) % longData.size();
+        longUsed -= numBytes;
+        return result;
+    }
+
+    std::vector<Bucket> buckets;
+    std::vector<Event> events;
+    juce::int64 wheelMask = 0;
+    int horizon = 0;
+    int freeList = -1;
+    int numPending = 0;
+    std::vector<juce::uint8> longData, longScratch;
+    size_t longRead = 0, longWrite = 0, longUsed = 0;
+};
@@ -0,0 +1,101 @@
+#include "MorphEngine.h"
+
+MorphEngine::MorphEngine()
+{
+    rebuildGains();
+}
+
+void MorphEngine::setCurve(Curve newCurve) noexcept
+{
+    if (newCurve == curve)
+        return;
+
+    curve = newCurve;
+    rebuildGains();
+}
+
+void MorphEngine::setSources(const HarmonicTable& from, const HarmonicTable& to) noexcept
+{
+    numColumnsLastUpdated = 0;
+
+    for (int i = 0; i < HarmonicSeries::numHarmonics; ++i)
+    {
+        if (from[(size_t) i] != sourceFrom[(size_t) i] || to[(size_t) i] != sourceTo[(size_t) i])
+        {
+            sourceFrom[(size_t) i] = from[(size_t) i];
+            sourceTo[(size_t) i] = to[(size_t) i];
+            rebuildColumn(i);
+        }
+    }
+}
+
+void MorphEngine::lookup(float morph, HarmonicTable& result) const noexcept
+{
+    const float position = juce::jlimit(0.0f, 1.0f, morph) * numSteps;
+    const int step = juce::jmin(static_cast<int>(position), numSteps - 1);
+    const float fraction = position - static_cast<float>(step);
+
+    for (size_t i = 0; i < HarmonicSeries::numHarmonics; ++i)
+    {
+        const auto& column = columns[i];
+        result[i] = column[(size_t) step] + fraction * (column[(size_t) step + 1] - column[(size_t) step]);
+    }
+}
+
+void MorphEngine::rebuildGains() noexcept
+{
+    constexpr int numPartials = HarmonicSeries::numHarmonics;
+
+    for (int i = 0; i < numPartials; ++i)
+    {
+        for (int step = 0; step <= numSteps; ++step)
+        {
+            const float t = static_cast<float>(step) / numSteps;
+            float toGain = t;
+
+            switch (curve)
+            {
+                case Curve::linear:
+                    break;
+
+                case Curve::equalPower:
+                    toGain = std::sin(t * juce::MathConstants<float>::halfPi);
+                    break;
+
+                case Curve::staggered:
+                {
+                    // Each partial fades over half the morph range, spread evenly
+                    const float start = 0.5f * static_cast<float>(i) / (numPartials - 1);
+                    toGain = juce::jlimit(0.0f, 1.0f, (t - start) * 2.0f);
+                    break;
+                }
+            }
+
+            const float fromGain = curve == Curve::equalPower
+                                       ? std::cos(t * juce::MathConstants<float>::halfPi)
+                                       : 1.0f - toGain;
+
+            fromGains[(size_t) i][(size_t) step] = fromGain;
+            toGains[(size_t) i][(size_t) step] = toGain;
+        }
+    }
+
+    for (int i = 0; i < numPartials; ++i)
+        rebuildColumn(i);
+
+    numColumnsLastUpdated = numPartials;
+}
+
+void MorphEngine::rebuildColumn(int partial) noexcept
+{
+    auto& column = columns[(size_t) partial];
+    constexpr int size = numSteps + 1;
+
+    juce::FloatVectorOperations::copyWithMultiply(column.data(), fromGains[(size_t) partial].data(), sourceFrom[(size_t) partial], size);
+    juce::FloatVectorOperations::addWithMultiply(column.data(), toGains[(size_t) partial].data(), sourceTo[(size_t) partial], size);
+
+    // Equal power overshoots where both tables are strong, strengths stay within 0..1
+    juce::FloatVectorOperations::clip(column.data(), column.data(), 0.0f, 1.0f, size);
+
+    ++numColumnsLastUpdated;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "HarmonicTable.h"
+#include <juce_core/juce_core.h>
+
+// Precomputed harm1 -> harm2 morph. Every partial gets a column of
+// numSteps + 1 interpolated strengths along the morph, shaped by the
+// selected curve, so a morph move is a lookup and a lerp per partial.
+//
+// Columns are contiguous, so when a source table changes only the partials
+// that actually differ are rebuilt, as two vectorised passes each.
+class MorphEngine
+{
+public:
+    static constexpr int numSteps = 256;
+
+    enum class Curve
+    {
+        linear,     // straight cross-fade
+        equalPower, // constant-power sine/cosine cross-fade
+        staggered   // higher partials start and finish their fade later
+    };
+
+    MorphEngine();
+
+    void setCurve(Curve newCurve) noexcept;
+    void setSources(const HarmonicTable& from, const HarmonicTable& to) noexcept;
+
+    void lookup(float morph, HarmonicTable& result) const noexcept;
+
+    // How many partial columns the last setSources() call rebuilt
+    int getNumColumnsLastUpdated() const noexcept { return numColumnsLastUpdated; }
+
+private:
+    using Column = std::array<float, numSteps + 1>;
+
+    void rebuildGains() noexcept;
+    void rebuildColumn(int partial) noexcept;
+
+    Curve curve = Curve::linear;
+    HarmonicTable sourceFrom {};
+    HarmonicTable sourceTo {};
+
+    // Per partial: weight of the "from" and "to" table at every step
+    std::array<Column, HarmonicSeries::numHarmonics> fromGains;
+    std::array<Column, HarmonicSeries::numHarmonics> toGains;
+    std::array<Column, HarmonicSeries::numHarmonics> columns;
+    int numColumnsLastUpdated = 0;
+};
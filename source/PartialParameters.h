@@ -0,0 +1,160 @@
+#pragma once
+#include "HarmonicTable.h"
+#include <juce_audio_processors/juce_audio_processors.h>
+
+// Every partial of harm1, harm2 and combo as a host parameter, so a host
+// can automate single partials of harm1 and harm2.
+//
+// Nothing polls them. Each parameter's listener sets its bit in a dirty
+// mask, and once per block the audio thread takes the bits set since the
+// last one and rebuilds only those entries. The listener also sets a bit in
+// a second mask and triggers an async update, which hands those bits to
+// onChange on the message thread, so the processor's own copies follow
+// automation whether or not an editor is open.
+//
+// Combo's parameters are read-only outputs that show the morph's result.
+// They can't be automated and nothing reads them back.
+class PartialParameters : private juce::AudioProcessorParameter::Listener,
+                          private juce::AsyncUpdater
+{
+public:
+    enum Table
+    {
+        harm1,
+        harm2,
+        combo,
+        numTables
+    };
+
+    static constexpr int numParameters = numTables * HarmonicSeries::numHarmonics;
+    static_assert(numParameters <= 32, "the dirty masks hold one bit per parameter");
+
+    static constexpr juce::uint32 tableMask(int table) noexcept
+    {
+        return ((1u << HarmonicSeries::numHarmonics) - 1) << (table * HarmonicSeries::numHarmonics);
+    }
+
+    static constexpr int bitFor(int table, int partial) noexcept { return table * HarmonicSeries::numHarmonics + partial; }
+
+    // Partial i is the (i + 2)th harmonic, e.g. "Harm1_H2" is harm1's octave
+    static juce::String getParameterID(int table, int partial)
+    {
+        static const char* const prefixes[] { "Harm1", "Harm2", "Combo" };
+        return juce::String(prefixes[table]) + "_H" + juce::String(partial + 2);
+    }
+
+    static void addTo(juce::AudioProcessorValueTreeState::ParameterLayout& layout)
+    {
+        static const char* const names[] { "Harm 1", "Harm 2", "Combo" };
+
+        const auto output = juce::AudioParameterFloatAttributes().withAutomatable(false).withCategory(juce::AudioProcessorParameter::otherMeter);
+
+        for (int table = 0; table < numTables; ++table)
+            for (int partial = 0; partial < HarmonicSeries::numHarmonics; ++partial)
+                layout.add(std::make_unique<juce::AudioParameterFloat>(
+                    juce::ParameterID(getParameterID(table, partial), 1),
+                    juce::String(names[table]) + " H" + juce::String(partial + 2),
+                    juce::NormalisableRange<float>(0.0f, 1.0f),
+                    0.0f,
+                    table == combo ? output : juce::AudioParameterFloatAttributes()
+                ));
+    }
+
+    PartialParameters() = default;
+
+    ~PartialParameters() override
+    {
+        cancelPendingUpdate();
+
+        for (auto* parameter : parameters)
+            if (parameter != nullptr)
+                parameter->removeListener(this);
+    }
+
+    // Message thread: called with the harm1 and harm2 partials that moved
+    // since the last call, one bit each
+    std::function<void(juce::uint32 changes)> onChange;
+
+    // Message thread: calls onChange now if it's waiting for its async update
+    void handleChangesNow() { handleUpdateNowIfNeeded(); }
+
+    void attach(juce::AudioProcessorValueTreeState& apvts)
+    {
+        for (int table = 0; table < numTables; ++table)
+        {
+            for (int partial = 0; partial < HarmonicSeries::numHarmonics; ++partial)
+            {
+                auto* parameter = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(getParameterID(table, partial)));
+                jassert(parameter != nullptr);
+
+                parameters[(size_t) bitFor(table, partial)] = parameter;
+                if (table != combo)
+                    parameter->addListener(this);
+            }
+        }
+
+        // The layout adds them in a run, so a listener maps its index to a bit with a subtraction
+        firstIndex = parameters[0]->getParameterIndex();
+        jassert(parameters.back()->getParameterIndex() == firstIndex + numParameters - 1);
+    }
+
+    // Audio thread: the parameters changed since the last call, one bit each
+    juce::uint32 takeChanges() noexcept { return audioChanges.exchange(0, std::memory_order_acquire); }
+
+    float getValue(int table, int partial) const noexcept { return parameters[(size_t) bitFor(table, partial)]->get(); }
+
+    juce::Array<float> getTable(int table) const
+    {
+        juce::Array<float> values;
+        for (int partial = 0; partial < HarmonicSeries::numHarmonics; ++partial)
+            values.add(getValue(table, partial));
+
+        return values;
+    }
+
+    // Copies every partial whose bit is set in changes into its table
+    void read(juce::uint32 changes, int table, HarmonicTable& result) const noexcept
+    {
+        for (int partial = 0; partial < HarmonicSeries::numHarmonics; ++partial)
+            if ((changes >> bitFor(table, partial)) & 1u)
+                result[(size_t) partial] = getValue(table, partial);
+    }
+
+    // Message thread: moves a table's parameters to values, telling the host
+    // about the partials that actually changed
+    void setTable(int table, const juce::Array<float>& values)
+    {
+        for (int partial = 0; partial < juce::jmin(HarmonicSeries::numHarmonics, values.size()); ++partial)
+        {
+            auto* parameter = parameters[(size_t) bitFor(table, partial)];
+            const float value = juce::jlimit(0.0f, 1.0f, values[partial]);
+
+            if (parameter->get() != value)
+                parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        }
+    }
+
+private:
+    void parameterValueChanged(int parameterIndex, float) override
+    {
+        const auto bit = 1u << (parameterIndex - firstIndex);
+        audioChanges.fetch_or(bit, std::memory_order_release);
+        viewChanges.fetch_or(bit, std::memory_order_release);
+        triggerAsyncUpdate();
+    }
+
+    void parameterGestureChanged(int, bool) override {}
+
+    void handleAsyncUpdate() override
+    {
+        if (const auto changes = viewChanges.exchange(0, std::memory_order_acquire); changes != 0 && onChange != nullptr)
+            onChange(changes);
+    }
+
+    std::array<juce::AudioParameterFloat*, numParameters> parameters {};
+    int firstIndex = 0;
+    std::atomic<juce::uint32> audioChanges { 0 };
+    std::atomic<juce::uint32> viewChanges { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartialParameters)
+};
@@ -0,0 +1,187 @@
+#include "PitchTracker.h"
+
+void PitchTracker::prepare (double newSampleRate, int maxBlockSize)
+{
+    sampleRate = newSampleRate;
+
+    // The window has to hold two periods of the lowest note
+    windowSize = juce::nextPowerOfTwo (juce::roundToInt (2.0 * sampleRate / lowestFrequency));
+    maxLag = windowSize / 2;
+    minLag = juce::jmax (2, static_cast<int> (sampleRate / highestFrequency));
+    hopSize = windowSize / 8;
+
+    // Zero padded to 2W so the correlation doesn't wrap around
+    const int fftSize = 2 * windowSize;
+    fft = std::make_unique<juce::dsp::FFT> (juce::roundToInt (std::log2 (fftSize)));
+
+    ring.calloc ((size_t) (2 * windowSize));
+    mono.calloc ((size_t) juce::jmax (1, maxBlockSize));
+    windowSpectrum.calloc ((size_t) (2 * fftSize));
+    headSpectrum.calloc ((size_t) (2 * fftSize));
+    difference.calloc ((size_t) maxLag);
+    monoSize = juce::jmax (1, maxBlockSize);
+
+    reset();
+}
+
+void PitchTracker::reset()
+{
+    juce::FloatVectorOperations::clear (ring.get(), 2 * windowSize);
+    ringPosition = 0;
+    samplesUntilHop = hopSize;
+    currentNote = candidateNote = -1;
+    candidateCount = 0;
+    lastEstimate = {};
+}
+
+void PitchTracker::process (const float* const* channels, int numChannels, int numSamples, juce::MidiBuffer& midi)
+{
+    if (numChannels <= 0 || windowSize == 0)
+        return;
+
+    for (int start = 0; start < numSamples; start += monoSize)
+    {
+        const int chunk = juce::jmin (monoSize, numSamples - start);
+
+        // Mono mixdown
+        juce::FloatVectorOperations::copy (mono.get(), channels[0] + start, chunk);
+        for (int ch = 1; ch < numChannels; ++ch)
+            juce::FloatVectorOperations::add (mono.get(), channels[ch] + start, chunk);
+        if (numChannels > 1)
+            juce::FloatVectorOperations::multiply (mono.get(), 1.0f / (float) numChannels, chunk);
+
+        for (int i = 0; i < chunk; ++i)
+        {
+            // Written twice, so the latest window is always ring[ringPosition .. ringPosition + W)
+            ring[ringPosition] = ring[ringPosition + windowSize] = mono[i];
+            ringPosition = (ringPosition + 1) % windowSize;
+
+            if (--samplesUntilHop == 0)
+            {
+                samplesUntilHop = hopSize;
+                lastEstimate = analyse();
+                updateNote (lastEstimate, start + i, midi);
+            }
+        }
+    }
+}
+
+PitchTracker::Estimate PitchTracker::analyse()
+{
+    const float* x = ring.get() + ringPosition;
+    const int fftSize = 2 * windowSize;
+    Estimate estimate;
+
+    // The gate only looks at the newest hop, so notes stop as soon as the input does
+    float energy = 0.0f;
+    for (int j = windowSize - hopSize; j < windowSize; ++j)
+        energy += x[j] * x[j];
+
+    estimate.level = std::sqrt (energy / (float) hopSize);
+    if (estimate.level < gateLevel)
+        return estimate;
+
+    // acf(tau) = sum over j < W/2 of x[j] * x[j + tau], as one spectral product
+    juce::FloatVectorOperations::clear (windowSpectrum.get(), 2 * fftSize);
+    juce::FloatVectorOperations::clear (headSpectrum.get(), 2 * fftSize);
+    juce::FloatVectorOperations::copy (windowSpectrum.get(), x, windowSize);
+    juce::FloatVectorOperations::copy (headSpectrum.get(), x, maxLag);
+
+    fft->performRealOnlyForwardTransform (windowSpectrum.get(), true);
+    fft->performRealOnlyForwardTransform (headSpectrum.get(), true);
+
+    for (int bin = 0; bin <= fftSize / 2; ++bin)
+    {
+        const float a = windowSpectrum[2 * bin], b = windowSpectrum[2 * bin + 1];
+        const float c = headSpectrum[2 * bin], d = headSpectrum[2 * bin + 1];
+        windowSpectrum[2 * bin] = a * c + b * d;
+        windowSpectrum[2 * bin + 1] = b * c - a * d;
+    }
+
+    // Conjugate symmetric upper half, for backends that read it
+    for (int bin = fftSize / 2 + 1; bin < fftSize; ++bin)
+    {
+        windowSpectrum[2 * bin] = windowSpectrum[2 * (fftSize - bin)];
+        windowSpectrum[2 * bin + 1] = -windowSpectrum[2 * (fftSize - bin) + 1];
+    }
+
+    fft->performRealOnlyInverseTransform (windowSpectrum.get());
+    const float* acf = windowSpectrum.get();
+
+    // YIN difference d(tau) = E(head) + E(shifted head) - 2 acf(tau),
+    // then the cumulative mean normalised difference in place
+    float headEnergy = 0.0f;
+    for (int j = 0; j < maxLag; ++j)
+        headEnergy += x[j] * x[j];
+
+    float shiftedEnergy = headEnergy;
+    float runningSum = 0.0f;
+    difference[0] = 1.0f;
+
+    for (int tau = 1; tau < maxLag; ++tau)
+    {
+        shiftedEnergy += x[tau + maxLag - 1] * x[tau + maxLag - 1] - x[tau - 1] * x[tau - 1];
+        const float d = juce::jmax (0.0f, headEnergy + shiftedEnergy - 2.0f * acf[tau]);
+        runningSum += d;
+        difference[tau] = runningSum > 0.0f ? d * (float) tau / runningSum : 1.0f;
+    }
+
+    // First dip under the threshold, followed down to its minimum
+    int bestLag = -1;
+    for (int tau = minLag; tau < maxLag - 1; ++tau)
+    {
+        if (difference[tau] < threshold)
+        {
+            while (tau + 1 < maxLag - 1 && difference[tau + 1] < difference[tau])
+                ++tau;
+
+            bestLag = tau;
+            break;
+        }
+    }
+
+    if (bestLag < 0)
+        return estimate;
+
+    // Parabolic interpolation between neighbouring lags
+    const float left = difference[bestLag - 1], centre = difference[bestLag], right = difference[bestLag + 1];
+    const float denominator = left - 2.0f * centre + right;
+    const float shift = std::abs (denominator) > 1.0e-9f ? 0.5f * (left - right) / denominator : 0.0f;
+
+    estimate.frequency = static_cast<float> (sampleRate / ((float) bestLag + juce::jlimit (-0.5f, 0.5f, shift)));
+    estimate.confidence = 1.0f - centre;
+    return estimate;
+}
+
+void PitchTracker::updateNote (const Estimate& estimate, int samplePosition, juce::MidiBuffer& midi)
+{
+    const int note = estimate.frequency > 0.0f
+                         ? juce::jlimit (0, 127, juce::roundToInt (69.0f + 12.0f * std::log2 (estimate.frequency / 440.0f)))
+                         : -1;
+
+    if (note == currentNote)
+    {
+        candidateNote = note;
+        candidateCount = 0;
+        return;
+    }
+
+    // Two hops in a row before anything changes, so vibrato and noise don't chatter
+    candidateCount = note == candidateNote ? candidateCount + 1 : 1;
+    candidateNote = note;
+    if (candidateCount < 2)
+        return;
+
+    if (currentNote >= 0)
+        midi.addEvent (juce::MidiMessage::noteOff (channel, currentNote), samplePosition);
+
+    if (note >= 0)
+    {
+        const float decibels = juce::jlimit (-40.0f, 0.0f, juce::Decibels::gainToDecibels (estimate.level));
+        const int velocity = juce::roundToInt (juce::jmap (decibels, -40.0f, 0.0f, 1.0f, 127.0f));
+        midi.addEvent (juce::MidiMessage::noteOn (channel, note, static_cast<juce::uint8> (velocity)), samplePosition);
+    }
+
+    currentNote = note;
+    candidateCount = 0;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_dsp/juce_dsp.h>
+
+// Monophonic pitch detector that turns audio into base notes.
+//
+// YIN over a sliding window, with the difference function built from an
+// FFT cross-correlation instead of the O(W^2) direct sum. The input is
+// mixed to mono into a ring buffer and analysed every hop; a note has to
+// be seen on two consecutive hops before it starts (or changes), and
+// stops when the signal drops below the gate or turns unpitched.
+//
+// prepare() allocates everything, process() is realtime safe.
+class PitchTracker
+{
+public:
+    static constexpr float lowestFrequency = 60.0f;
+    static constexpr float highestFrequency = 1500.0f;
+
+    struct Estimate
+    {
+        float frequency = 0.0f; // 0 when unpitched
+        float confidence = 0.0f;
+        float level = 0.0f;     // RMS of the newest hop
+    };
+
+    void prepare (double sampleRate, int maxBlockSize);
+    void reset();
+
+    void setChannel (int midiChannel) noexcept { channel = juce::jlimit (1, 16, midiChannel); }
+    void setThreshold (float newThreshold) noexcept { threshold = newThreshold; }
+    void setGate (float newGateLevel) noexcept { gateLevel = newGateLevel; }
+
+    // Analyses numSamples of audio and adds note-on/note-off events to midi
+    void process (const float* const* channels, int numChannels, int numSamples, juce::MidiBuffer& midi);
+
+    void process (const juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi)
+    {
+        process (buffer.getArrayOfReadPointers(), buffer.getNumChannels(), buffer.getNumSamples(), midi);
+    }
+
+    const Estimate& getLastEstimate() const noexcept { return lastEstimate; }
+    int getCurrentNote() const noexcept { return currentNote; }
+    int getWindowSize() const noexcept { return windowSize; }
+    int getHopSize() const noexcept { return hopSize; }
+
+private:
+    Estimate analyse();
+    void updateNote (const Estimate& estimate, int samplePosition, juce::MidiBuffer& midi);
+
+    double sampleRate = 48000.0;
+    int windowSize = 0;     // W, two periods of the lowest frequency
+    int hopSize = 0;
+    int maxLag = 0;         // W / 2
+    int minLag = 0;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    juce::HeapBlock<float> ring;       // last W mono samples, twice over so a window is contiguous
+    juce::HeapBlock<float> mono;
+    juce::HeapBlock<float> windowSpectrum;
+    juce::HeapBlock<float> headSpectrum;
+    juce::HeapBlock<float> difference;
+    int monoSize = 0;
+    int ringPosition = 0;
+    int samplesUntilHop = 0;
+
+    float threshold = 0.15f;
+    float gateLevel = 0.01f;
+    int channel = 1;
+    int currentNote = -1;
+    int candidateNote = -1;
+    int candidateCount = 0;
+    Estimate lastEstimate;
+};
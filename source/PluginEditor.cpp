@@ -1,7 +1,9 @@
 #include "PluginEditor.h"
+#include <set>
 
 PluginEditor::PluginEditor(PluginProcessor& p)
     : AudioProcessorEditor(&p), processorRef(p),
+      xyPad(*p.getAPVTS().getParameter("MorphX"), *p.getAPVTS().getParameter("MorphY")),
       resizer(this, &constrainer)
 {
     // Initialize the background drawable
@@ -21,6 +23,49 @@ PluginEditor::PluginEditor(PluginProcessor& p)
     morphAttachment = std::make_unique<juce::AudioProcessorValueTreeState::SliderAttachment>(
         processorRef.getAPVTS(), "Morph", morphSlider);
     
+    // Vector morph controls
+    addAndMakeVisible(xyPad);
+    xyPad.setBankState(processorRef.getBankState());
+    xyPad.onValueChange = [this]() { refreshCombo(); };
+    xyPad.onDragStart = [this]() { padDragStart = { xyPad.getXValue(), xyPad.getYValue() }; };
+    xyPad.onDragEnd = [this]() {
+        auto& history = processorRef.getEditHistory();
+        history.beginGesture();
+        history.record(EditHistory::morphXTarget, 0, padDragStart.x, xyPad.getXValue());
+        history.record(EditHistory::morphYTarget, 0, padDragStart.y, xyPad.getYValue());
+        history.endGesture();
+    };
+
+    morphModeBox.addItemList({ "Linear Morph", "Vector Morph" }, 1);
+    addAndMakeVisible(morphModeBox);
+    morphModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        processorRef.getAPVTS(), "MorphMode", morphModeBox);
+    morphModeBox.onChange = [this]() { refreshCombo(); };
+
+    morphCurveBox.addItemList({ "Linear Curve", "Equal Power Curve", "Staggered Curve" }, 1);
+    addAndMakeVisible(morphCurveBox);
+    morphCurveAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        processorRef.getAPVTS(), "MorphCurve", morphCurveBox);
+    morphCurveBox.onChange = [this]() { refreshCombo(); };
+
+    for (int slot = 0; slot < TableBank::maxTables; ++slot)
+        slotSelector.addItem("Slot " + juce::String(slot + 1), slot + 1);
+    slotSelector.setSelectedId(1, juce::dontSendNotification);
+    slotSelector.onChange = [this]() { selectEditSlot(slotSelector.getSelectedId() - 1); };
+    addAndMakeVisible(slotSelector);
+
+    // Instances given the same link group play one set of tables and one morph
+    linkGroupEditor.setTextToShowWhenEmpty("Link group", juce::Colours::grey);
+    linkGroupEditor.setText(processorRef.getLinkGroup(), juce::dontSendNotification);
+    auto applyLinkGroup = [this]() {
+        processorRef.setLinkGroup(linkGroupEditor.getText());
+        linkGroupEditor.setText(processorRef.getLinkGroup(), juce::dontSendNotification);
+        refreshViews();
+    };
+    linkGroupEditor.onReturnKey = applyLinkGroup;
+    linkGroupEditor.onFocusLost = applyLinkGroup;
+    addAndMakeVisible(linkGroupEditor);
+
     // Initialize harmonics with stored values
     harm1.setHarmonicData(processorRef.getHarm1Data());
     harm2.setHarmonicData(processorRef.getHarm2Data());
@@ -28,37 +73,38 @@ PluginEditor::PluginEditor(PluginProcessor& p)
     
     // Add value change listeners for direct manipulation of harmonics
     harm1.onValueChange = [this]() {
-        processorRef.setHarmonicData(
-            harm1.getHarmonicData(),
-            harm2.getHarmonicData(),
-            combo.getHarmonicData()
-        );
+        processorRef.setBankTable(editSlot, harm1.getHarmonicData());
+        if (editSlot == 1)
+            harm2.setHarmonicData(harm1.getHarmonicData());
+        refreshCombo();
     };
     
     harm2.onValueChange = [this]() {
-        processorRef.setHarmonicData(
-            harm1.getHarmonicData(),
-            harm2.getHarmonicData(),
-            combo.getHarmonicData()
-        );
+        processorRef.setBankTable(1, harm2.getHarmonicData());
+        if (editSlot == 1)
+            harm1.setHarmonicData(harm2.getHarmonicData());
+        refreshCombo();
+    };
+
+    // Drawing on combo overrides the morph until it moves again
+    combo.onValueChange = [this]() {
+        processorRef.setComboOverride(combo.getHarmonicData());
     };
+
+    recordTableEdits(harm1, [this]() { return editSlot; });
+    recordTableEdits(harm2, []() { return 1; });
+    recordTableEdits(combo, []() { return (int) EditHistory::comboTarget; });
+
+    // Dropping a recording onto a table fills it with the recording's harmonics
+    harm1.onFileDropped = [this](const juce::File& file) { analyseSample(file, harm1, [this]() { return editSlot; }); };
+    harm2.onFileDropped = [this](const juce::File& file) { analyseSample(file, harm2, []() { return 1; }); };
+    combo.onFileDropped = [this](const juce::File& file) { analyseSample(file, combo, []() { return (int) EditHistory::comboTarget; }); };
     
-    // Existing morph slider callback
-    morphSlider.onValueChange = [this]() {
-        float value = static_cast<float>(morphSlider.getValue());
-        for (int i = 0; i < Harm::numValues; ++i)
-        {
-            float v1 = harm1.getValue(i);
-            float v2 = harm2.getValue(i);
-            float interpolatedValue = v1 * (1.0f - value) + v2 * value;
-            combo.setValue(i, interpolatedValue);
-        }
-        // Store updated values in processor
-        processorRef.setHarmonicData(
-            harm1.getHarmonicData(),
-            harm2.getHarmonicData(),
-            combo.getHarmonicData()
-        );
+    // The processor blends combo on the audio thread, this only updates the view
+    morphSlider.onValueChange = [this]() { refreshCombo(); };
+    morphSlider.onDragStart = [this]() { morphDragStart = (float) morphSlider.getValue(); };
+    morphSlider.onDragEnd = [this]() {
+        processorRef.getEditHistory().record(EditHistory::morphTarget, 0, morphDragStart, (float) morphSlider.getValue());
     };
     
     // Set up resizing constraints
@@ -78,6 +124,23 @@ PluginEditor::PluginEditor(PluginProcessor& p)
     addAndMakeVisible(loadPresetButton);
     loadPresetButton.onClick = [this]() { loadPreset(); };
 
+    addAndMakeVisible(findSimilarButton);
+    findSimilarButton.onClick = [this]() { findSimilarPresets(); };
+
+    addAndMakeVisible(exportButton);
+    exportButton.onClick = [this]() { exportWavetables(); };
+
+    addAndMakeVisible(undoButton);
+    undoButton.onClick = [this]() { undo(); };
+
+    addAndMakeVisible(redoButton);
+    redoButton.onClick = [this]() { redo(); };
+
+    setWantsKeyboardFocus(true);
+
+    // Follows host automation of the partial parameters
+    startTimerHz(30);
+
 #if JUCE_WINDOWS
     currentPresetDirectory = juce::File::getSpecialLocation(juce::File::commonApplicationDataDirectory)
                             .getChildFile(JucePlugin_Manufacturer)
@@ -90,6 +153,24 @@ PluginEditor::PluginEditor(PluginProcessor& p)
 
     // Ensure directory exists
     currentPresetDirectory.createDirectory();
+
+    // Built from the factory .preset files and installed next to them
+    factoryBank.open(currentPresetDirectory.getChildFile("Factory.presetbank"));
+
+    // Stepping applies presets that were decoded in the background
+    presetNavigator.onPresetLoaded = [this](const juce::File&, const PresetFields& fields) {
+        applyPreset(PresetData::fromFields(fields));
+    };
+    presetNavigator.setFolder(currentPresetDirectory);
+
+    addAndMakeVisible(prevPresetButton);
+    prevPresetButton.onClick = [this]() { presetNavigator.step(-1); };
+
+    addAndMakeVisible(nextPresetButton);
+    nextPresetButton.onClick = [this]() { presetNavigator.step(1); };
+
+    // Picks up presets saved since the last scan, in the background
+    processorRef.getPresetLibrary().scan(currentPresetDirectory, currentPresetDirectory.getChildFile("Factory.presetbank"));
 }
 
 PluginEditor::~PluginEditor()
@@ -118,6 +199,7 @@ void PluginEditor::resized()
     
     // Reserve space for slider at bottom
     auto sliderArea = area.removeFromBottom(50);
+    linkGroupEditor.setBounds(sliderArea.removeFromRight(130).reduced(10, 12));
     morphSlider.setBounds(sliderArea.reduced(10));
 
     // Space for inspect button
@@ -129,18 +211,29 @@ void PluginEditor::resized()
     auto buttonsY = buttonArea.getY() + 10;
     
     // Position the preset browser buttons
-    // prevPresetButton.setBounds(10, buttonsY, buttonWidth, 30);
-    // nextPresetButton.setBounds(buttonWidth + buttonSpacing + 10, buttonsY, buttonWidth, 30);
+    prevPresetButton.setBounds(10, buttonsY, buttonWidth, 30);
+    nextPresetButton.setBounds(buttonWidth + buttonSpacing + 10, buttonsY, buttonWidth, 30);
+    exportButton.setBounds(nextPresetButton.getRight() + buttonSpacing, buttonsY, 120, 30);
     
     // Adjust existing save/load buttons position
     auto centerButtonsX = (getWidth() - (2 * 100 + buttonSpacing)) / 2;
     savePresetButton.setBounds(centerButtonsX, buttonsY, 100, 30);
     loadPresetButton.setBounds(centerButtonsX + 100 + buttonSpacing, buttonsY, 100, 30);
+    redoButton.setBounds(getWidth() - buttonWidth - 20, buttonsY, buttonWidth, 30);
+    undoButton.setBounds(redoButton.getX() - buttonWidth - buttonSpacing, buttonsY, buttonWidth, 30);
+    findSimilarButton.setBounds(undoButton.getX() - 100 - buttonSpacing, buttonsY, 100, 30);
     
     // Divide remaining space horizontally for harm1, combo, and harm2
     auto thirdWidth = area.getWidth() / 3;
+    auto selectorArea = area.removeFromTop(30);
+    slotSelector.setBounds(selectorArea.removeFromLeft(thirdWidth).reduced(10, 2));
+    morphModeBox.setBounds(selectorArea.removeFromLeft(thirdWidth).reduced(10, 2));
+    morphCurveBox.setBounds(selectorArea.reduced(10, 2));
+
     harm1.setBounds(area.removeFromLeft(thirdWidth).reduced(10));
-    combo.setBounds(area.removeFromLeft(thirdWidth).reduced(10));
+    auto comboArea = area.removeFromLeft(thirdWidth);
+    xyPad.setBounds(comboArea.removeFromBottom(comboArea.getHeight() / 2).reduced(10));
+    combo.setBounds(comboArea.reduced(10));
     harm2.setBounds(area.reduced(10));
 }
 
@@ -217,10 +310,23 @@ void PluginEditor::savePreset()
                 data.comboData = combo.getHarmonicData();
                 data.morphValue = static_cast<float>(morphSlider.getValue());
                 
-                data.saveToFile(presetFile);
+                // Written in the background, the library picks it up once it is on disk
+                juce::Component::SafePointer<PluginEditor> safeThis(this);
+                processorRef.getPresetSaveQueue().save(presetFile, data.toFields(), [safeThis](const juce::File& file, bool saved) {
+                    if (safeThis == nullptr)
+                        return;
+
+                    if (! saved)
+                    {
+                        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Save Preset",
+                                                               "Couldn't save " + file.getFullPathName());
+                        return;
+                    }
 
-                // Refresh the preset list
-                // updatePresetList();
+                    safeThis->presetNavigator.setCurrentPreset(file);
+                    safeThis->processorRef.getPresetLibrary().scan(safeThis->currentPresetDirectory,
+                                                                   safeThis->currentPresetDirectory.getChildFile("Factory.presetbank"));
+                });
             }
             dialogWindow.reset();  // Add this line to clean up
         }
@@ -228,6 +334,214 @@ void PluginEditor::savePreset()
 }
 
 void PluginEditor::loadPreset()
+{
+    // Factory presets come straight from the bank, anything else from disk
+    juce::PopupMenu menu;
+    menu.addItem(1, "Browse...");
+    menu.addItem(2, "Analyse Sample Folder...", ! sampleAnalyser.isAnalysingFolder());
+
+    if (factoryBank.getNumPresets() > 0)
+    {
+        menu.addSeparator();
+        menu.addSectionHeader("Factory");
+        for (int i = 0; i < factoryBank.getNumPresets(); ++i)
+            menu.addItem(i + 3, factoryBank.getName(i));
+    }
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&loadPresetButton),
+        [this](int result) {
+            if (result == 1)
+                browseForPreset();
+            else if (result == 2)
+                analyseSampleFolder();
+            else if (result > 2)
+                loadFactoryPreset(result - 3);
+        });
+}
+
+void PluginEditor::loadFactoryPreset(int index)
+{
+    PresetFields fields;
+    if (factoryBank.getPreset(index, fields))
+        applyPreset(PresetData::fromFields(fields));
+}
+
+void PluginEditor::findSimilarPresets()
+{
+    HarmonicTable query {};
+    const auto current = combo.getHarmonicData();
+    for (int i = 0; i < HarmonicSeries::numHarmonics; ++i)
+        query[(size_t) i] = current[i];
+
+    findSimilarButton.setEnabled(false);
+    findSimilarButton.setButtonText("Searching...");
+
+    // Partial results arrive as each chunk of the library is searched
+    juce::Component::SafePointer<PluginEditor> safeThis(this);
+    processorRef.getPresetLibrary().findSimilar(query, 10, [safeThis](const PresetLibrary::Results& results) {
+        if (safeThis == nullptr || ! results.finished)
+            return;
+
+        safeThis->findSimilarButton.setEnabled(true);
+        safeThis->findSimilarButton.setButtonText("Find Similar");
+        safeThis->showSimilarPresets(results);
+    });
+}
+
+void PluginEditor::showSimilarPresets(const PresetLibrary::Results& results)
+{
+    juce::PopupMenu menu;
+
+    if (results.matches.empty())
+        menu.addItem(1, "No presets found", false);
+
+    for (size_t i = 0; i < results.matches.size(); ++i)
+        menu.addItem((int) i + 1, results.index->getName(results.matches[i].index));
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&findSimilarButton),
+        [this, results](int result) {
+            PresetFields fields;
+            if (result > 0 && (size_t) result <= results.matches.size()
+                && results.index->loadPreset(results.matches[(size_t) result - 1].index, fields))
+                applyPreset(PresetData::fromFields(fields));
+        });
+}
+
+void PluginEditor::exportWavetables()
+{
+    juce::PopupMenu menu;
+    menu.addItem(1, "Combo table");
+    menu.addItem(2, "Morph sweep");
+    menu.addItem(3, "Morph sweep of every preset");
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&exportButton), [this](int result) {
+        if (result == 0)
+            return;
+
+        // Wavetables go in a folder next to the presets
+        const auto folder = currentPresetDirectory.getChildFile("Wavetables");
+        const auto curve = static_cast<MorphEngine::Curve>(juce::jlimit(0, 2, morphCurveBox.getSelectedItemIndex()));
+        const int sweepFrames = MorphEngine::numSteps;
+
+        auto toTable = [](const juce::Array<float>& values) {
+            HarmonicTable table {};
+            for (int i = 0; i < juce::jmin(HarmonicSeries::numHarmonics, values.size()); ++i)
+                table[(size_t) i] = values[i];
+            return table;
+        };
+
+        std::vector<WavetableExporter::Job> jobs;
+
+        if (result == 1)
+        {
+            const auto table = toTable(combo.getHarmonicData());
+            jobs.push_back({ folder.getNonexistentChildFile("Combo", ".wav"), table, table, 1, curve });
+        }
+        else if (result == 2)
+        {
+            jobs.push_back({ folder.getNonexistentChildFile("Morph", ".wav"),
+                             toTable(processorRef.getHarm1Data()), toTable(processorRef.getHarm2Data()), sweepFrames, curve });
+        }
+        else if (auto index = processorRef.getPresetLibrary().getIndex())
+        {
+            // Each job reads its own preset on a worker. A user preset named
+            // like a bank one, or like another in a different folder, gets a
+            // file of its own
+            std::set<juce::String> usedNames;
+            for (int i = 0; i < index->getNumPresets(); ++i)
+            {
+                const auto name = juce::File::createLegalFileName(index->getName(i)) + (index->isBankPreset(i) ? " (Bank)" : "");
+                auto uniqueName = name;
+                for (int n = 2; ! usedNames.insert(uniqueName.toLowerCase()).second; ++n)
+                    uniqueName = name + " " + juce::String(n);
+
+                jobs.push_back({ folder.getChildFile(uniqueName + ".wav"), {}, {}, sweepFrames, curve,
+                                 [index, i](WavetableExporter::Job& job) {
+                                     PresetFields fields;
+                                     if (! index->loadPreset(i, fields))
+                                         return false;
+
+                                     job.from = fields.harm1;
+                                     job.to = fields.harm2;
+                                     return true;
+                                 } });
+            }
+        }
+
+        startExport(std::move(jobs));
+    });
+}
+
+void PluginEditor::startExport(std::vector<WavetableExporter::Job> jobs)
+{
+    exportButton.setEnabled(false);
+    exportButton.setButtonText("Exporting...");
+
+    juce::Component::SafePointer<PluginEditor> safeThis(this);
+    wavetableExporter.exportTables(std::move(jobs), {}, [safeThis](int numWritten) {
+        if (safeThis == nullptr)
+            return;
+
+        safeThis->exportButton.setEnabled(true);
+        safeThis->exportButton.setButtonText("Export Wavetable");
+        if (numWritten > 0)
+            safeThis->currentPresetDirectory.getChildFile("Wavetables").revealToUser();
+    });
+}
+
+void PluginEditor::analyseSample(const juce::File& file, Harm& table, std::function<int()> target)
+{
+    // The table follows the running average as it comes in, and the whole drop undoes as one step
+    const auto before = table.getHarmonicData();
+
+    sampleAnalyser.analyse(file, [this, file, &table, before, target](const SampleAnalyser::Result& result) {
+        if (result.fundamental <= 0.0f)
+        {
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Analyse Sample",
+                                                   "Couldn't find a steady pitch in " + file.getFileName());
+            return;
+        }
+
+        const juce::Array<float> values(result.table.data(), (int) result.table.size());
+        table.setHarmonicData(values);
+        if (table.onValueChange != nullptr)
+            table.onValueChange();
+
+        if (result.finished)
+        {
+            auto& history = processorRef.getEditHistory();
+            history.beginGesture();
+            for (int i = 0; i < values.size(); ++i)
+                history.record(target(), i, before[i], values[i]);
+            history.endGesture();
+        }
+    });
+}
+
+void PluginEditor::analyseSampleFolder()
+{
+    sampleFolderChooser = std::make_unique<juce::FileChooser>("Analyse every sample in a folder", currentPresetDirectory);
+    sampleFolderChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectDirectories,
+        [this](const juce::FileChooser& chooser) {
+            const auto folder = chooser.getResult();
+            if (! folder.isDirectory())
+                return;
+
+            // One preset per sample, in a folder next to the presets
+            const auto destination = currentPresetDirectory.getChildFile("Analysed");
+            juce::Component::SafePointer<PluginEditor> safeThis(this);
+            sampleAnalyser.analyseFolder(folder, destination, [safeThis, destination](int numWritten) {
+                if (safeThis == nullptr || numWritten == 0)
+                    return;
+
+                safeThis->processorRef.getPresetLibrary().scan(safeThis->currentPresetDirectory,
+                                                               safeThis->currentPresetDirectory.getChildFile("Factory.presetbank"));
+                destination.revealToUser();
+            });
+        });
+}
+
+void PluginEditor::browseForPreset()
 {
     // Create file browser component
     auto tempBrowser = std::make_unique<juce::FileBrowserComponent>(
@@ -264,18 +578,8 @@ void PluginEditor::loadPreset()
                     juce::File selectedFile = fileBrowser->getSelectedFile(true);
                     if (selectedFile.existsAsFile())
                     {
-                        auto data = PresetData::loadFromFile(selectedFile);
-                        harm1.setHarmonicData(data.harm1Data);
-                        harm2.setHarmonicData(data.harm2Data);
-                        combo.setHarmonicData(data.comboData);
-                        morphSlider.setValue(data.morphValue, juce::sendNotification);
-                        
-                        // Store in processor
-                        processorRef.setHarmonicData(
-                            data.harm1Data,
-                            data.harm2Data,
-                            data.comboData
-                        );
+                        applyPreset(PresetData::loadFromFile(selectedFile));
+                        presetNavigator.setCurrentPreset(selectedFile);
                     }
                 }
             }
@@ -284,6 +588,103 @@ void PluginEditor::loadPreset()
         }));
 }
 
+void PluginEditor::applyPreset(const PresetData& data)
+{
+    // Store in processor first, so the morph below blends the new tables
+    processorRef.setHarmonicData(
+        data.harm1Data,
+        data.harm2Data,
+        data.comboData,
+        true
+    );
+
+    // The history refers to the tables being replaced, as would a running analysis
+    processorRef.getEditHistory().clear();
+    sampleAnalyser.cancel();
+
+    slotSelector.setSelectedId(1, juce::dontSendNotification);
+    editSlot = 0;
+    harm1.setHarmonicData(data.harm1Data);
+    harm2.setHarmonicData(data.harm2Data);
+    combo.setHarmonicData(data.comboData);
+    morphSlider.setValue(data.morphValue, juce::sendNotification);
+}
+
+void PluginEditor::refreshCombo()
+{
+    combo.setHarmonicData(processorRef.updateComboFromMorph());
+    xyPad.setBankState(processorRef.getBankState());
+}
+
+void PluginEditor::selectEditSlot(int slot)
+{
+    // A running analysis belongs to the slot it was dropped on
+    sampleAnalyser.cancel();
+    editSlot = juce::jlimit(0, TableBank::maxTables - 1, slot);
+    harm1.setHarmonicData(processorRef.getBankTable(editSlot));
+}
+
+void PluginEditor::recordTableEdits(Harm& table, std::function<int()> target)
+{
+    auto& history = processorRef.getEditHistory();
+    table.onGestureStart = [&history]() { history.beginGesture(); };
+    table.onGestureEnd = [&history]() { history.endGesture(); };
+    table.onBarEdited = [&history, target](int index, float oldValue, float newValue) {
+        history.record(target(), index, oldValue, newValue);
+    };
+}
+
+void PluginEditor::undo()
+{
+    if (processorRef.undo())
+        refreshViews();
+}
+
+void PluginEditor::redo()
+{
+    if (processorRef.redo())
+        refreshViews();
+}
+
+void PluginEditor::refreshViews()
+{
+    // Parameter targets update their controls through the attachments
+    harm1.setHarmonicData(processorRef.getBankTable(editSlot));
+    harm2.setHarmonicData(processorRef.getHarm2Data());
+    combo.setHarmonicData(processorRef.getComboData());
+    xyPad.setBankState(processorRef.getBankState());
+}
+
+void PluginEditor::timerCallback()
+{
+    if (processorRef.takeOutsideChanges())
+        refreshViews();
+
+    // A session load can move this instance to another group
+    if (! linkGroupEditor.hasKeyboardFocus(true) && linkGroupEditor.getText() != processorRef.getLinkGroup())
+        linkGroupEditor.setText(processorRef.getLinkGroup(), juce::dontSendNotification);
+}
+
+bool PluginEditor::keyPressed(const juce::KeyPress& key)
+{
+    const auto command = juce::ModifierKeys::commandModifier;
+    const auto shift = juce::ModifierKeys::shiftModifier;
+
+    if (key == juce::KeyPress('z', command, 0))
+    {
+        undo();
+        return true;
+    }
+
+    if (key == juce::KeyPress('z', command | shift, 0) || key == juce::KeyPress('y', command, 0))
+    {
+        redo();
+        return true;
+    }
+
+    return false;
+}
+
 juce::Array<float> PluginEditor::getComboHarmonicData() const
 {
     return combo.getHarmonicData();
@@ -5,9 +5,15 @@
 #include "melatonin_inspector/melatonin_inspector.h"
 #include "Harm.h"
 #include "Preset.h"
+#include "PresetBank.h"
+#include "PresetNavigator.h"
+#include "SampleAnalyser.h"
+#include "WavetableExporter.h"
+#include "XYPad.h"
 
 class PluginEditor : public juce::AudioProcessorEditor,
-                    public juce::FileBrowserListener
+                    public juce::FileBrowserListener,
+                    private juce::Timer
 {
 public:
     explicit PluginEditor (PluginProcessor&);
@@ -22,12 +28,30 @@ public:
     void fileDoubleClicked(const juce::File&) override {}
     void browserRootChanged(const juce::File&) override {}
 
+    bool keyPressed(const juce::KeyPress& key) override;
+
     juce::Array<float> getComboHarmonicData() const;
 
 private:
     // Member functions
     void savePreset();
     void loadPreset();
+    void browseForPreset();
+    void loadFactoryPreset(int index);
+    void findSimilarPresets();
+    void showSimilarPresets(const PresetLibrary::Results& results);
+    void exportWavetables();
+    void startExport(std::vector<WavetableExporter::Job> jobs);
+    void analyseSample(const juce::File& file, Harm& table, std::function<int()> target);
+    void analyseSampleFolder();
+    void applyPreset(const PresetData& data);
+    void refreshCombo();
+    void selectEditSlot(int slot);
+    void recordTableEdits(Harm& table, std::function<int()> target);
+    void undo();
+    void redo();
+    void refreshViews();
+    void timerCallback() override;
 
     // Member variables
     PluginProcessor& processorRef;
@@ -35,18 +59,39 @@ private:
     juce::TextButton inspectButton { "Inspect the UI" };
     juce::TextButton savePresetButton { "Save Preset" };
     juce::TextButton loadPresetButton { "Load Preset" };
+    juce::TextButton prevPresetButton { "<" };
+    juce::TextButton nextPresetButton { ">" };
+    juce::TextButton findSimilarButton { "Find Similar" };
+    juce::TextButton exportButton { "Export Wavetable" };
+    juce::TextButton undoButton { "Undo" };
+    juce::TextButton redoButton { "Redo" };
     std::unique_ptr<juce::Drawable> background;
     Harm harm1 { juce::Colour(0xffc7884d) };
     Harm combo { juce::Colour(0xffE0E0E0) };
     Harm harm2 { juce::Colour(0xff89b4c1) };
     juce::Slider morphSlider;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> morphAttachment;
+    XYPad xyPad;
+    juce::ComboBox morphModeBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> morphModeAttachment;
+    juce::ComboBox morphCurveBox;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> morphCurveAttachment;
+    juce::ComboBox slotSelector; // which bank slot the left table edits
+    juce::TextEditor linkGroupEditor;
+    int editSlot = 0;
+    float morphDragStart = 0.0f;
+    juce::Point<float> padDragStart;
     juce::ResizableCornerComponent resizer;
     juce::ComponentBoundsConstrainer constrainer;
 
     std::unique_ptr<juce::DialogWindow> fileBrowserDialog;
     juce::FileBrowserComponent* fileBrowser = nullptr;
     juce::File currentPresetDirectory;
+    PresetBank factoryBank;
+    PresetNavigator presetNavigator;
+    WavetableExporter wavetableExporter;
+    SampleAnalyser sampleAnalyser;
+    std::unique_ptr<juce::FileChooser> sampleFolderChooser;
 
     // Alert window for save dialog
     std::unique_ptr<juce::AlertWindow> dialogWindow;
@@ -1,6 +1,19 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
+static HarmonicTable toHarmonicTable(const juce::Array<float>& values)
+{
+    HarmonicTable table {};
+    for (int i = 0; i < juce::jmin(HarmonicSeries::numHarmonics, values.size()); ++i)
+        table[(size_t) i] = values[i];
+    return table;
+}
+
+static juce::Array<float> toArray(const HarmonicTable& table)
+{
+    return juce::Array<float>(table.data(), HarmonicSeries::numHarmonics);
+}
+
 //==============================================================================
 PluginProcessor::PluginProcessor()
      : AudioProcessor (BusesProperties()
@@ -24,10 +37,38 @@ PluginProcessor::PluginProcessor()
         harm2Data.set(i, 0.0f);
         comboData.set(i, 0.0f);
     }
+
+    morphParam = apvts.getRawParameterValue("Morph");
+    morphModeParam = apvts.getRawParameterValue("MorphMode");
+    morphCurveParam = apvts.getRawParameterValue("MorphCurve");
+    morphXParam = apvts.getRawParameterValue("MorphX");
+    morphYParam = apvts.getRawParameterValue("MorphY");
+    decimateControllersParam = apvts.getRawParameterValue("DecimateControllers");
+    maxVoicesParam = apvts.getRawParameterValue("MaxVoices");
+    maxEventsPerBlockParam = apvts.getRawParameterValue("MaxEventsPerBlock");
+    stealPolicyParam = apvts.getRawParameterValue("StealPolicy");
+    transitionTimeParam = apvts.getRawParameterValue("TransitionTime");
+    lookaheadParam = apvts.getRawParameterValue("Lookahead");
+    strumParam = apvts.getRawParameterValue("Strum");
+    humanizeParam = apvts.getRawParameterValue("Humanize");
+    midiOutputParam = apvts.getRawParameterValue("MidiOutput");
+    for (int i = 0; i < HarmonicSeries::numHarmonics; ++i)
+        routeParams[(size_t) i] = apvts.getRawParameterValue("Route_H" + juce::String(i + 2));
+    partialParameters.attach(apvts);
+    partialParameters.onChange = [this](juce::uint32 changes) { pullPartialParameterChanges(changes); };
+    apvts.addParameterListener("Lookahead", this);
+
+    ++bankVersion;
+    publishTables();
 }
 
 PluginProcessor::~PluginProcessor()
 {
+    apvts.removeParameterListener("Lookahead", this);
+    cancelPendingUpdate();
+
+    if (linkGroup != nullptr)
+        linkGroup->leave(*this);
 }
 
 //==============================================================================
@@ -98,9 +139,18 @@ void PluginProcessor::changeProgramName (int index, const juce::String& newName)
 //==============================================================================
 void PluginProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    // Use this method as the place to do any pre-playback
-    // initialisation that you need..
-    juce::ignoreUnused (sampleRate, samplesPerBlock);
+    lookaheadLatency = juce::roundToInt(sampleRate * lookaheadSeconds);
+    harmonicGenerator.prepare(samplesPerBlock, lookaheadLatency);
+    umpOutput.prepare(juce::jmax(samplesPerBlock, 256) * (1 + HarmonicSeries::numHarmonics));
+    crossfader.prepare(sampleRate);
+    pitchTracker.prepare(sampleRate, samplesPerBlock);
+    additiveSynth.prepare(sampleRate, samplesPerBlock);
+   #if JucePlugin_IsSynth
+    // Large patches render on a few cores, leaving the rest for the host.
+    // The workers are shared by every instance, so this doesn't add up.
+    additiveSynth.setNumThreads(juce::SystemStats::getNumPhysicalCpus() / 2);
+   #endif
+    setLatencySamples(getLookaheadLatency());
 }
 
 void PluginProcessor::releaseResources()
@@ -109,6 +159,12 @@ void PluginProcessor::releaseResources()
     // spare memory, etc.
 }
 
+void PluginProcessor::audioWorkgroupContextChanged (const juce::AudioWorkgroup& workgroup)
+{
+    // The render workers join the host's audio threads, so it schedules them together
+    additiveSynth.setAudioWorkgroup(workgroup);
+}
+
 bool PluginProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
   #if JucePlugin_IsMidiEffect
@@ -134,81 +190,128 @@ bool PluginProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 void PluginProcessor::processBlock(juce::AudioBuffer<float>& buffer,
                                  juce::MidiBuffer& midiMessages)
 {
-    // Helper function to convert frequency ratio to semitones
-    auto ratioToSemitones = [](float ratio) {
-        return static_cast<int>(std::round(12.0f * std::log2(ratio)));
-    };
+    tableHandoff.acquire();
 
-    juce::MidiBuffer processedMidi;
-    
-    for (const auto metadata : midiMessages)
-    {
-        const auto message = metadata.getMessage();
-        const auto time = metadata.samplePosition;
-
-        if (message.isNoteOn())
-        {
-            const int baseNote = message.getNoteNumber();
-            const int baseVelocity = message.getVelocity();
-            
-            processedMidi.addEvent(message, time);
-            
-            // Use stored data directly instead of accessing editor
-            auto& harmonicData = comboData;
-            
-            for (int i = 0; i < harmonicData.size(); ++i)
-            {
-                float harmonicStrength = harmonicData[i];
-                if (harmonicStrength > 0.0f)
-                {
-                    // Calculate the frequency ratio for this harmonic
-                    // Harmonic series is 1:2:3:4:5:6:7:8
-                    float ratio = static_cast<float>(i + 2); // +2 because i starts at 0
-                    int harmonicNote = baseNote + ratioToSemitones(ratio);
-                    
-                    int harmonicVelocity = juce::jlimit(1, 127, 
-                        static_cast<int>(baseVelocity * harmonicStrength));
-                    
-                    if (harmonicNote <= 127)
-                    {
-                        processedMidi.addEvent(
-                            juce::MidiMessage::noteOn(message.getChannel(), 
-                                                        harmonicNote, 
-                                                        static_cast<uint8_t>(harmonicVelocity)),
-                            time);
-                    }
-                }
-            }
-        }
-        else if (message.isNoteOff())
-        {
-            const int baseNote = message.getNoteNumber();
-            processedMidi.addEvent(message, time);
-            
-            // Send note-offs using the same ratio calculation
-            for (int i = 0; i < 8; ++i)
-            {
-                float ratio = static_cast<float>(i + 2);
-                int harmonicNote = baseNote + ratioToSemitones(ratio);
-                if (harmonicNote <= 127)
-                {
-                    processedMidi.addEvent(
-                        juce::MidiMessage::noteOff(message.getChannel(), harmonicNote),
-                        time);
-                }
-            }
-        }
+    // A linked instance plays what its group last published, read in place
+    audioLinkGroup.read([this](const std::shared_ptr<LinkGroup>& group) {
+        if (group == nullptr)
+            updateTables(tableHandoff.getReadBuffer(), nullptr);
         else
-        {
-            processedMidi.addEvent(message, time);
-        }
-    }
-    
-    midiMessages.swapWith(processedMidi);
+            group->read([this, &group](const PublishedTables& tables) { updateTables(tables, group.get()); });
+    });
+
+    harmonicGenerator.setDecimateControllers(decimateControllersParam->load() > 0.5f);
+    harmonicGenerator.setLimits(static_cast<int>(maxVoicesParam->load()),
+                                static_cast<int>(maxEventsPerBlockParam->load()));
+    harmonicGenerator.setStealPolicy(stealPolicyParam->load() < 0.5f
+                                         ? VoicePriorityQueue::Policy::weakestHarmonic
+                                         : VoicePriorityQueue::Policy::oldestNote);
+
+    const int latency = getLookaheadLatency();
+
+    HarmonicGenerator::Routing routing;
+    for (size_t i = 0; i < routing.size(); ++i)
+        routing[i] = static_cast<int>(routeParams[i]->load());
+    harmonicGenerator.setRouting(routing);
+
+    const auto samplesPerMs = static_cast<float>(getSampleRate() * 0.001);
+    harmonicGenerator.setLookahead(latency, strumParam->load() * samplesPerMs, humanizeParam->load() * samplesPerMs);
+
+   #if ! JucePlugin_IsMidiEffect && ! JucePlugin_IsSynth
+    // Notes heard on the audio input join the incoming MIDI as base notes
+    pitchTracker.process(buffer, midiMessages);
+   #endif
+
+   #if ! JucePlugin_IsSynth
+    const bool midi2Output = midiOutputParam->load() > 0.5f;
+    umpOutput.clear();
+    harmonicGenerator.setUmpOutput(midi2Output ? &umpOutput : nullptr);
+    harmonicGenerator.process(midiMessages, crossfader, buffer.getNumSamples());
+
+    // The plugin formats only carry MIDI 1.0, so the packets always leave converted
+    if (midi2Output)
+        umpOutput.convertToMidi1(midiMessages);
+   #endif
 
     // Clear audio outputs
     for (auto i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
+
+   #if JucePlugin_IsSynth
+    // The synth build plays the base notes with the table as partials instead of sending MIDI
+    additiveSynth.render(buffer, midiMessages, crossfader);
+    midiMessages.clear();
+   #endif
+
+    crossfader.advance(buffer.getNumSamples());
+}
+
+int PluginProcessor::getLookaheadLatency() const
+{
+   #if JucePlugin_IsSynth
+    // The synth renders its notes as they arrive, so there is nothing for the host to compensate
+    return 0;
+   #else
+    return lookaheadParam->load() > 0.5f ? lookaheadLatency.load() : 0;
+   #endif
+}
+
+void PluginProcessor::parameterChanged(const juce::String&, float)
+{
+    // Switching lookahead changes the latency the host compensates for.
+    // Hosts may automate it from the audio thread, where setLatencySamples()
+    // must not be called, so the message thread reports it
+    triggerAsyncUpdate();
+}
+
+void PluginProcessor::handleAsyncUpdate()
+{
+    setLatencySamples(getLookaheadLatency());
+}
+
+void PluginProcessor::updateTables(const PublishedTables& tables, LinkGroup* group)
+{
+    // Joining or leaving a group starts over from its tables, fading to them
+    const uint32_t groupId = group != nullptr ? group->getId() : 0;
+    const bool sourceChanged = groupId != lastLinkGroupId;
+    lastLinkGroupId = groupId;
+
+    // Automated partials only touch their own entries, and only the
+    // MorphEngine columns of partials that moved get rebuilt. A group's
+    // tables play as published, a member's partial parameters only move
+    // it while they are automated
+    const auto partialChanges = partialParameters.takeChanges();
+    const auto harmMask = PartialParameters::tableMask(PartialParameters::harm1) | PartialParameters::tableMask(PartialParameters::harm2);
+    const bool bankChanged = sourceChanged || tables.bankVersion != lastBankVersion;
+    const auto harmChanges = bankChanged && group == nullptr ? harmMask : partialChanges;
+    if (bankChanged)
+        audioBank = tables.bank;
+
+    partialParameters.read(harmChanges, PartialParameters::harm1, audioBank.tables[0]);
+    partialParameters.read(harmChanges, PartialParameters::harm2, audioBank.tables[1]);
+
+    // Members play the group's morph, which follows whichever member's own morph last moved
+    auto morphParameters = getMorphParameters();
+    if (group != nullptr)
+    {
+        if (! sourceChanged && morphParameters != lastOwnMorph)
+            group->setMorph(morphParameters);
+
+        lastOwnMorph = morphParameters;
+        morphParameters = group->getMorph();
+    }
+
+    morpher.update(audioBank, bankChanged || harmChanges != 0, morphParameters);
+    if (! sourceChanged && tables.comboVersion != lastComboVersion)
+        morpher.overrideTable(tables.combo);
+
+    // A preset change fades in rather than switching tables mid-phrase
+    crossfader.setTransitionTime(transitionTimeParam->load() * 0.001);
+    crossfader.setTarget(morpher.getTable(), sourceChanged || tables.transitionVersion != lastTransitionVersion);
+
+    lastBankVersion = tables.bankVersion;
+    lastComboVersion = tables.comboVersion;
+    lastTransitionVersion = tables.transitionVersion;
 }
 
 //==============================================================================
@@ -224,6 +327,48 @@ juce::AudioProcessorEditor* PluginProcessor::createEditor()
 
 //==============================================================================
 void PluginProcessor::getStateInformation(juce::MemoryBlock& destData)
+{
+    // Reads only the published snapshot, so this can run on any thread
+    // while the editor keeps editing
+    const auto& parameters = getParameters();
+    const auto version = stateSnapshot.read([](const StateSnapshot& snapshot) { return snapshot.version; });
+
+    // An instance that hasn't changed since its last save hands back the same blob
+    const bool reused = encodedState.read([&](const EncodedState& cached) {
+        if (cached.stateVersion != version || cached.parameterValues.size() != (size_t) parameters.size())
+            return false;
+
+        for (int i = 0; i < parameters.size(); ++i)
+            if (parameters[i]->getValue() != cached.parameterValues[(size_t) i])
+                return false;
+
+        destData = cached.data;
+        return true;
+    });
+
+    if (reused)
+        return;
+
+    // Values are taken before encoding, so a change in between only costs a re-encode next time
+    auto encoded = std::make_unique<EncodedState>();
+    for (auto* parameter : parameters)
+        encoded->parameterValues.push_back(parameter->getValue());
+
+    stateSnapshot.read([this, &encoded](const StateSnapshot& snapshot) {
+        encoded->stateVersion = snapshot.version;
+        encodeState(snapshot, encoded->data);
+        return true;
+    });
+
+    destData = encoded->data;
+
+    // Two threads saving at once: one of them keeps its blob
+    const juce::SpinLock::ScopedTryLockType lock(encodeLock);
+    if (lock.isLocked())
+        encodedState.publish(std::move(encoded));
+}
+
+void PluginProcessor::encodeState(const StateSnapshot& snapshot, juce::MemoryBlock& destData)
 {
     // Get automatable parameters state from APVTS
     auto state = apvts.copyState();
@@ -233,21 +378,42 @@ void PluginProcessor::getStateInformation(juce::MemoryBlock& destData)
     
     // Save harm1 data
     auto* harm1Xml = new juce::XmlElement("Harm1");
-    for (int i = 0; i < harm1Data.size(); ++i)
-        harm1Xml->setAttribute("h" + juce::String(i), harm1Data[i]);
+    for (int i = 0; i < snapshot.harm1.size(); ++i)
+        harm1Xml->setAttribute("h" + juce::String(i), snapshot.harm1[i]);
     harmonicsXml->addChildElement(harm1Xml);
     
     // Save harm2 data
     auto* harm2Xml = new juce::XmlElement("Harm2");
-    for (int i = 0; i < harm2Data.size(); ++i)
-        harm2Xml->setAttribute("h" + juce::String(i), harm2Data[i]);
+    for (int i = 0; i < snapshot.harm2.size(); ++i)
+        harm2Xml->setAttribute("h" + juce::String(i), snapshot.harm2[i]);
     harmonicsXml->addChildElement(harm2Xml);
     
     // Save combo data
     auto* comboXml = new juce::XmlElement("Combo");
-    for (int i = 0; i < comboData.size(); ++i)
-        comboXml->setAttribute("h" + juce::String(i), comboData[i]);
+    for (int i = 0; i < snapshot.combo.size(); ++i)
+        comboXml->setAttribute("h" + juce::String(i), snapshot.combo[i]);
     harmonicsXml->addChildElement(comboXml);
+
+    // Save any extra morph bank slots
+    const auto& bank = snapshot.bank;
+    auto* bankXml = new juce::XmlElement("Bank");
+    for (int slot = 2; slot < TableBank::maxTables; ++slot)
+    {
+        if (! bank.isActive(slot))
+            continue;
+
+        auto* slotXml = bankXml->createNewChildElement("Slot");
+        slotXml->setAttribute("index", slot);
+        slotXml->setAttribute("x", bank.x[(size_t) slot]);
+        slotXml->setAttribute("y", bank.y[(size_t) slot]);
+        for (int i = 0; i < HarmonicSeries::numHarmonics; ++i)
+            slotXml->setAttribute("h" + juce::String(i), bank.tables[(size_t) slot][(size_t) i]);
+    }
+    harmonicsXml->addChildElement(bankXml);
+
+    // Linked instances rejoin their group when the session reopens
+    if (snapshot.linkGroup.isNotEmpty())
+        harmonicsXml->createNewChildElement("Link")->setAttribute("group", snapshot.linkGroup);
     
     std::unique_ptr<juce::XmlElement> xml(state.createXml());
     xml->addChildElement(harmonicsXml);
@@ -262,26 +428,352 @@ void PluginProcessor::setStateInformation(const void* data, int sizeInBytes)
         if (xmlState->hasTagName(apvts.state.getType()))
         {
             apvts.replaceState(juce::ValueTree::fromXml(*xmlState));
-            
+
+            // The restored partial parameters are what was playing. Sessions
+            // saved before the partials were parameters only have them in HarmonicData
+            auto savedAsParameters = [&xmlState](int table) {
+                return xmlState->getChildByAttribute("id", PartialParameters::getParameterID(table, 0)) != nullptr;
+            };
+
             // Load harmonic data
             if (auto* harmonicsXml = xmlState->getChildByName("HarmonicData"))
             {
-                if (auto* harm1Xml = harmonicsXml->getChildByName("Harm1"))
+                if (savedAsParameters(PartialParameters::harm1))
+                    harm1Data = partialParameters.getTable(PartialParameters::harm1);
+                else if (auto* harm1Xml = harmonicsXml->getChildByName("Harm1"))
                     for (int i = 0; i < 8; ++i)
                         harm1Data.set(i, static_cast<float>(harm1Xml->getDoubleAttribute("h" + juce::String(i), 0.0)));
-                
-                if (auto* harm2Xml = harmonicsXml->getChildByName("Harm2"))
+
+                if (savedAsParameters(PartialParameters::harm2))
+                    harm2Data = partialParameters.getTable(PartialParameters::harm2);
+                else if (auto* harm2Xml = harmonicsXml->getChildByName("Harm2"))
                     for (int i = 0; i < 8; ++i)
                         harm2Data.set(i, static_cast<float>(harm2Xml->getDoubleAttribute("h" + juce::String(i), 0.0)));
                 
                 if (auto* comboXml = harmonicsXml->getChildByName("Combo"))
                     for (int i = 0; i < 8; ++i)
                         comboData.set(i, static_cast<float>(comboXml->getDoubleAttribute("h" + juce::String(i), 0.0)));
+
+                bankState = {};
+                if (auto* bankXml = harmonicsXml->getChildByName("Bank"))
+                {
+                    for (auto* slotXml : bankXml->getChildWithTagNameIterator("Slot"))
+                    {
+                        const int slot = slotXml->getIntAttribute("index", -1);
+                        if (slot < 2 || slot >= TableBank::maxTables)
+                            continue;
+
+                        auto& table = bankState.tables[(size_t) slot];
+                        for (int i = 0; i < HarmonicSeries::numHarmonics; ++i)
+                            table[(size_t) i] = static_cast<float>(slotXml->getDoubleAttribute("h" + juce::String(i), 0.0));
+
+                        bankState.x[(size_t) slot] = static_cast<float>(slotXml->getDoubleAttribute("x", bankState.x[(size_t) slot]));
+                        bankState.y[(size_t) slot] = static_cast<float>(slotXml->getDoubleAttribute("y", bankState.y[(size_t) slot]));
+                        bankState.activeMask |= 1u << slot;
+                    }
+                }
+
+                // Only moves the parameters of sessions that had none
+                partialParameters.setTable(PartialParameters::harm1, harm1Data);
+                partialParameters.setTable(PartialParameters::harm2, harm2Data);
+
+                // Combo is recomputed from the restored tables and morph parameters
+                bankState.tables[0] = toHarmonicTable(harm1Data);
+                bankState.tables[1] = toHarmonicTable(harm2Data);
+                ++bankVersion;
+                publishTables();
+                updateComboFromMorph();
+
+                auto* linkXml = harmonicsXml->getChildByName("Link");
+                setLinkGroup(linkXml != nullptr ? linkXml->getStringAttribute("group") : juce::String());
+            }
+        }
+    }
+}
+
+//==============================================================================
+void PluginProcessor::setHarmonicData(const juce::Array<float>& harm1,
+                                      const juce::Array<float>& harm2,
+                                      const juce::Array<float>& combo,
+                                      bool smoothTransition)
+{
+    if (smoothTransition)
+        ++transitionVersion;
+
+    harm1Data = harm1;
+    harm2Data = harm2;
+    comboData = combo;
+    partialParameters.setTable(PartialParameters::harm1, harm1Data);
+    partialParameters.setTable(PartialParameters::harm2, harm2Data);
+    partialParameters.setTable(PartialParameters::combo, comboData);
+
+    bankState.tables[0] = toHarmonicTable(harm1Data);
+    bankState.tables[1] = toHarmonicTable(harm2Data);
+    ++bankVersion;
+    ++comboVersion;
+    publishTables();
+}
+
+void PluginProcessor::setBankTable(int slot, const juce::Array<float>& values)
+{
+    if (! juce::isPositiveAndBelow(slot, TableBank::maxTables))
+        return;
+
+    if (slot == 0)
+    {
+        harm1Data = values;
+        partialParameters.setTable(PartialParameters::harm1, harm1Data);
+    }
+    else if (slot == 1)
+    {
+        harm2Data = values;
+        partialParameters.setTable(PartialParameters::harm2, harm2Data);
+    }
+
+    bankState.tables[(size_t) slot] = toHarmonicTable(values);
+    bankState.activeMask |= 1u << slot;
+    ++bankVersion;
+    publishTables();
+
+    updateComboFromMorph();
+}
+
+juce::Array<float> PluginProcessor::getBankTable(int slot) const
+{
+    if (! juce::isPositiveAndBelow(slot, TableBank::maxTables))
+        return {};
+
+    return toArray(bankState.tables[(size_t) slot]);
+}
+
+void PluginProcessor::setComboOverride(const juce::Array<float>& combo)
+{
+    comboData = combo;
+    partialParameters.setTable(PartialParameters::combo, comboData);
+    ++comboVersion;
+    publishTables();
+}
+
+const juce::Array<float>& PluginProcessor::updateComboFromMorph()
+{
+    const auto morphParameters = linkGroup != nullptr ? linkGroup->getMorph() : getMorphParameters();
+    const auto& table = previewMorpher.update(bankState, bankVersion != previewBankVersion, morphParameters);
+    previewBankVersion = bankVersion;
+
+    comboData = toArray(table);
+    partialParameters.setTable(PartialParameters::combo, comboData);
+    publishState();
+    return comboData;
+}
+
+void PluginProcessor::pullPartialParameterChanges(juce::uint32 changes)
+{
+    bool changed = false;
+
+    // Bits set by our own setTable() calls find the values already in place
+    auto pull = [this, changes, &changed](int table, juce::Array<float>& values) {
+        for (int i = 0; i < HarmonicSeries::numHarmonics; ++i)
+        {
+            const float value = partialParameters.getValue(table, i);
+            if (((changes >> PartialParameters::bitFor(table, i)) & 1u) && values[i] != value)
+            {
+                values.set(i, value);
+                changed = true;
             }
         }
+    };
+
+    pull(PartialParameters::harm1, harm1Data);
+    pull(PartialParameters::harm2, harm2Data);
+
+    if (changed)
+    {
+        // The audio thread already has them, this keeps the preview morph,
+        // the saved state and the editor in step
+        bankState.tables[0] = toHarmonicTable(harm1Data);
+        bankState.tables[1] = toHarmonicTable(harm2Data);
+        ++bankVersion;
+        publishTables();
+        updateComboFromMorph();
+        outsideChangesPending = true;
     }
 }
 
+void PluginProcessor::setLinkGroup(const juce::String& name)
+{
+    const auto groupName = name.trim();
+    if (groupName == getLinkGroup())
+        return;
+
+    if (linkGroup != nullptr)
+        linkGroup->leave(*this);
+
+    linkGroup.reset();
+
+    if (groupName.isNotEmpty())
+    {
+        PublishedTables tables;
+        tables.bank = bankState;
+        tables.combo = toHarmonicTable(comboData);
+        linkGroup = LinkGroup::join(groupName, *this, tables, getMorphParameters());
+
+        // A group that already has members brings its own tables, a new one starts from ours
+        applyLinkedTables(true, false);
+        lastViewedLinkMorph = linkGroup->getMorph();
+    }
+
+    // The group left behind is freed here once the audio thread stops reading it
+    audioLinkGroup.publish(std::make_unique<const std::shared_ptr<LinkGroup>>(linkGroup));
+    publishTables();
+}
+
+void PluginProcessor::linkedTablesChanged(bool bankChanged, bool comboChanged)
+{
+    if (linkGroup != nullptr)
+        applyLinkedTables(bankChanged, comboChanged);
+}
+
+void PluginProcessor::applyLinkedTables(bool bankChanged, bool comboChanged)
+{
+    // Another member's edit, mirrored for the editor, undo, the saved state
+    // and the partial parameters, which this instance plays again once it
+    // leaves the group. The audio thread already reads the group's copy
+    const auto tables = linkGroup->read([](const PublishedTables& current) { return current; });
+
+    if (bankChanged)
+    {
+        bankState = tables.bank;
+        harm1Data = toArray(bankState.tables[0]);
+        harm2Data = toArray(bankState.tables[1]);
+        partialParameters.setTable(PartialParameters::harm1, harm1Data);
+        partialParameters.setTable(PartialParameters::harm2, harm2Data);
+        ++bankVersion;
+        updateComboFromMorph();
+    }
+
+    if (comboChanged)
+    {
+        comboData = toArray(tables.combo);
+        partialParameters.setTable(PartialParameters::combo, comboData);
+        ++comboVersion;
+    }
+
+    linkedBankVersion = bankVersion;
+    linkedComboVersion = comboVersion;
+    outsideChangesPending = true;
+    publishState();
+}
+
+void PluginProcessor::handlePendingChangesNow()
+{
+    partialParameters.handleChangesNow();
+    handleLinkedChangesNow();
+}
+
+bool PluginProcessor::takeOutsideChanges()
+{
+    audioLinkGroup.collectGarbage();
+    const bool changed = outsideChangesPending;
+    outsideChangesPending = false;
+    if (linkGroup == nullptr)
+        return changed;
+
+    linkGroup->collectGarbage();
+
+    // The morph moves on the audio threads, so combo is brought up to date here
+    const auto morph = linkGroup->getMorph();
+    const bool morphMoved = morph != lastViewedLinkMorph;
+    if (morphMoved)
+    {
+        lastViewedLinkMorph = morph;
+        updateComboFromMorph();
+    }
+
+    return changed || morphMoved;
+}
+
+bool PluginProcessor::undo()
+{
+    return editHistory.undo([this](int target, int index, float value) { applyHistoryValue(target, index, value); });
+}
+
+bool PluginProcessor::redo()
+{
+    return editHistory.redo([this](int target, int index, float value) { applyHistoryValue(target, index, value); });
+}
+
+void PluginProcessor::applyHistoryValue(int target, int index, float value)
+{
+    if (juce::isPositiveAndBelow(target, TableBank::maxTables))
+    {
+        auto table = getBankTable(target);
+        table.set(index, value);
+        setBankTable(target, table);
+    }
+    else if (target == EditHistory::comboTarget)
+    {
+        auto table = comboData;
+        table.set(index, value);
+        setComboOverride(table);
+    }
+    else
+    {
+        const char* parameterID = target == EditHistory::morphTarget    ? "Morph"
+                                  : target == EditHistory::morphXTarget ? "MorphX"
+                                                                        : "MorphY";
+        if (auto* parameter = apvts.getParameter(parameterID))
+        {
+            parameter->beginChangeGesture();
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+            parameter->endChangeGesture();
+        }
+    }
+}
+
+void PluginProcessor::publishTables()
+{
+    auto& packet = tableHandoff.getWriteBuffer();
+    packet.bank = bankState;
+    packet.combo = toHarmonicTable(comboData);
+    packet.transitionVersion = transitionVersion;
+    packet.bankVersion = bankVersion;
+    packet.comboVersion = comboVersion;
+    tableHandoff.publish();
+
+    // Edits made here go to the rest of the group, tables mirrored from it are already there
+    const bool bankChanged = bankVersion != linkedBankVersion;
+    const bool comboChanged = comboVersion != linkedComboVersion;
+    const bool transition = transitionVersion != linkedTransitionVersion;
+    if (linkGroup != nullptr && (bankChanged || comboChanged || transition))
+        linkGroup->publish(bankState, toHarmonicTable(comboData), bankChanged, comboChanged, transition, this);
+
+    linkedBankVersion = bankVersion;
+    linkedComboVersion = comboVersion;
+    linkedTransitionVersion = transitionVersion;
+    publishState();
+}
+
+void PluginProcessor::publishState()
+{
+    auto snapshot = std::make_unique<StateSnapshot>();
+    snapshot->harm1 = harm1Data;
+    snapshot->harm2 = harm2Data;
+    snapshot->combo = comboData;
+    snapshot->bank = bankState;
+    snapshot->linkGroup = getLinkGroup();
+    snapshot->version = ++stateVersion;
+    stateSnapshot.publish(std::move(snapshot));
+}
+
+TableBank::MorphParameters PluginProcessor::getMorphParameters() const
+{
+    return { morphModeParam->load() < 0.5f ? TableBank::MorphMode::linear : TableBank::MorphMode::vector,
+             static_cast<MorphEngine::Curve>(juce::jlimit(0, 2, static_cast<int>(morphCurveParam->load()))),
+             morphParam->load(),
+             morphXParam->load(),
+             morphYParam->load() };
+}
+
 juce::AudioProcessorValueTreeState::ParameterLayout PluginProcessor::createParameterLayout()
 {
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
@@ -293,7 +785,130 @@ juce::AudioProcessorValueTreeState::ParameterLayout PluginProcessor::createParam
         1.0f,       // maximum value
         0.5f        // default value
     ));
-    
+
+    // Linear morphs harm1 -> harm2, Vector blends every bank slot from the XY pad
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("MorphMode", 1),
+        "Morph Mode",
+        juce::StringArray { "Linear", "Vector" },
+        0
+    ));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("MorphCurve", 1),
+        "Morph Curve",
+        juce::StringArray { "Linear", "Equal Power", "Staggered" },
+        0
+    ));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("MorphX", 1),
+        "Morph X",
+        0.0f,
+        1.0f,
+        0.5f
+    ));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("MorphY", 1),
+        "Morph Y",
+        0.0f,
+        1.0f,
+        0.5f
+    ));
+
+    // Keep only the last value of each high-rate controller stream per block.
+    // Off by default, as it thins the player's own controller data too
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID("DecimateControllers", 1),
+        "Decimate Controllers",
+        false
+    ));
+
+    // Bound the downstream load: harmonic polyphony and generated events per block
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID("MaxVoices", 1),
+        "Max Harmonic Voices",
+        1,
+        VoicePriorityQueue::capacity,
+        VoicePriorityQueue::capacity
+    ));
+
+    layout.add(std::make_unique<juce::AudioParameterInt>(
+        juce::ParameterID("MaxEventsPerBlock", 1),
+        "Max Events Per Block",
+        16,
+        4096,
+        4096
+    ));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("StealPolicy", 1),
+        "Voice Stealing",
+        juce::StringArray { "Weakest Harmonic", "Oldest Note" },
+        0
+    ));
+
+    // How long a preset change takes to fade in
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("TransitionTime", 1),
+        "Transition Time",
+        juce::NormalisableRange<float>(0.0f, 2000.0f, 1.0f, 0.5f),
+        250.0f,
+        juce::AudioParameterFloatAttributes().withLabel("ms")
+    ));
+
+    // Lookahead delays everything by a fixed latency so harmonics can land
+    // before or after their base note: negative strum rolls up to the beat
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+        juce::ParameterID("Lookahead", 1),
+        "Lookahead",
+        false
+    ));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("Strum", 1),
+        "Strum",
+        juce::NormalisableRange<float>(-50.0f, 50.0f, 0.1f),
+        0.0f,
+        juce::AudioParameterFloatAttributes().withLabel("ms")
+    ));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>(
+        juce::ParameterID("Humanize", 1),
+        "Humanize",
+        juce::NormalisableRange<float>(0.0f, 20.0f, 0.1f),
+        0.0f,
+        juce::AudioParameterFloatAttributes().withLabel("ms")
+    ));
+
+    // MIDI 2.0 builds the harmonics as UMP with 16-bit velocities and exact
+    // pitch, internally only: they are converted to MIDI 1.0 on the way out
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+        juce::ParameterID("MidiOutput", 1),
+        "MIDI Output",
+        juce::StringArray { "MIDI 1.0", "MIDI 2.0 (internal)" },
+        0
+    ));
+
+    // Sends each partial to its own channel, or keeps the base note's
+    juce::StringArray routeChoices { "Input Channel" };
+    for (int channel = 1; channel <= 16; ++channel)
+        routeChoices.add("Channel " + juce::String(channel));
+
+    for (int i = 0; i < HarmonicSeries::numHarmonics; ++i)
+    {
+        layout.add(std::make_unique<juce::AudioParameterChoice>(
+            juce::ParameterID("Route_H" + juce::String(i + 2), 1),
+            "H" + juce::String(i + 2) + " Output Channel",
+            routeChoices,
+            0
+        ));
+    }
+
+    // One parameter per partial, for automating single harmonics
+    PartialParameters::addTo(layout);
+
     return layout;
 }
 
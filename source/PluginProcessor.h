@@ -1,12 +1,26 @@
 #pragma once
 
+#include "AdditiveSynth.h"
+#include "EditHistory.h"
+#include "HarmonicGenerator.h"
+#include "LinkGroup.h"
+#include "PartialParameters.h"
+#include "PitchTracker.h"
+#include "PresetLibrary.h"
+#include "PresetSaveQueue.h"
+#include "SharedSnapshot.h"
+#include "TableBank.h"
+#include "TripleBuffer.h"
 #include <juce_audio_processors/juce_audio_processors.h>
 
 #if (MSVC)
 #include "ipps.h"
 #endif
 
-class PluginProcessor : public juce::AudioProcessor
+class PluginProcessor : public juce::AudioProcessor,
+                        private LinkGroup::Listener,
+                        private juce::AudioProcessorValueTreeState::Listener,
+                        private juce::AsyncUpdater
 {
 public:
     PluginProcessor();
@@ -14,6 +28,7 @@ public:
 
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
+    void audioWorkgroupContextChanged (const juce::AudioWorkgroup& workgroup) override;
 
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
 
@@ -42,13 +57,50 @@ public:
     juce::AudioProcessorValueTreeState& getAPVTS() { return apvts; }
 
     // Add getters and setters for harmonic data
+    // These are message thread only: changes reach the audio thread through a lock-free handoff
+    // smoothTransition ramps the audio thread over TransitionTime, as for a preset change
     void setHarmonicData(const juce::Array<float>& harm1, 
                         const juce::Array<float>& harm2,
-                        const juce::Array<float>& combo) {
-        harm1Data = harm1;
-        harm2Data = harm2;
-        comboData = combo;
-    }
+                        const juce::Array<float>& combo,
+                        bool smoothTransition = false);
+
+    // The morph bank. Slot 0 is harm1 and slot 1 is harm2
+    void setBankTable(int slot, const juce::Array<float>& values);
+    juce::Array<float> getBankTable(int slot) const;
+    bool isBankSlotActive(int slot) const { return bankState.isActive(slot); }
+    const TableBank::State& getBankState() const { return bankState; }
+
+    // A table drawn straight onto combo, used until the morph moves again
+    void setComboOverride(const juce::Array<float>& combo);
+
+    // Recomputes combo from the bank and the current morph parameters,
+    // exactly as the audio thread does, and returns it
+    const juce::Array<float>& updateComboFromMorph();
+
+    // Undo/redo of table edits and morph moves, message thread only
+    EditHistory& getEditHistory() { return editHistory; }
+    bool undo();
+    bool redo();
+
+    // Outlives the editor, so the index is only built once per session
+    PresetLibrary& getPresetLibrary() { return presetLibrary; }
+
+    // Also outlives the editor, so closing it never drops a save in progress
+    PresetSaveQueue& getPresetSaveQueue() { return presetSaveQueue; }
+
+    // Joins the instances in this process that use the same group name, so
+    // they all play one set of tables and one morph. An empty name unlinks.
+    void setLinkGroup(const juce::String& name);
+    juce::String getLinkGroup() const { return linkGroup != nullptr ? linkGroup->getName() : juce::String(); }
+
+    // Message thread: true if host automation or another member of the
+    // group changed the tables, or the group's morph moved, since the last
+    // call. Also refreshes combo from a linked morph.
+    bool takeOutsideChanges();
+
+    // Message thread: applies changes still waiting for their async update
+    // now, rather than on a later pass of the message loop
+    void handlePendingChangesNow();
 
     const juce::Array<float>& getHarm1Data() const { return harm1Data; }
     const juce::Array<float>& getHarm2Data() const { return harm2Data; }
@@ -57,10 +109,106 @@ public:
 private:
     juce::AudioProcessorValueTreeState apvts { *this, nullptr, "Parameters", createParameterLayout() };
     
+    // Every harm1/harm2/combo partial as a host parameter, combo's read-only
+    PartialParameters partialParameters;
+
     // Add storage for harmonic data
     juce::Array<float> harm1Data;
     juce::Array<float> harm2Data;
     juce::Array<float> comboData;
 
+    // What getStateInformation() saves besides the parameters, republished
+    // whenever the message thread changes it, so any thread can read it
+    struct StateSnapshot
+    {
+        juce::Array<float> harm1, harm2, combo;
+        TableBank::State bank;
+        juce::String linkGroup;
+        uint32_t version = 0;
+    };
+
+    // The last blob getStateInformation() produced, and what it was made from
+    struct EncodedState
+    {
+        uint32_t stateVersion = 0;
+        std::vector<float> parameterValues;
+        juce::MemoryBlock data;
+    };
+
+    void publishTables();
+    void publishState();
+    void updateTables(const PublishedTables& tables, LinkGroup* group);
+    void pullPartialParameterChanges(juce::uint32 changes);
+    void linkedTablesChanged(bool bankChanged, bool comboChanged) override;
+    void applyLinkedTables(bool bankChanged, bool comboChanged);
+    void encodeState(const StateSnapshot& snapshot, juce::MemoryBlock& destData);
+    void applyHistoryValue(int target, int index, float value);
+    TableBank::MorphParameters getMorphParameters() const;
+    int getLookaheadLatency() const;
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+
+    // Message thread side of the bank, previewMorpher mirrors what the audio thread computes
+    TableBank::State bankState;
+    TableMorpher previewMorpher;
+    uint32_t previewBankVersion = 0;
+    uint32_t bankVersion = 0;
+    uint32_t comboVersion = 0;
+    uint32_t transitionVersion = 0;
+    TripleBuffer<PublishedTables> tableHandoff;
+
+    // Linked instances play their group's tables instead of tableHandoff.
+    // The audio thread reads the group through a snapshot, so leaving never
+    // frees a group it is still reading
+    std::shared_ptr<LinkGroup> linkGroup;
+    SharedSnapshot<std::shared_ptr<LinkGroup>> audioLinkGroup;
+    uint32_t linkedBankVersion = 0;
+    uint32_t linkedComboVersion = 0;
+    uint32_t linkedTransitionVersion = 0;
+    bool outsideChangesPending = false;
+    TableBank::MorphParameters lastViewedLinkMorph;
+    uint32_t stateVersion = 0;
+    SharedSnapshot<StateSnapshot> stateSnapshot;
+    SharedSnapshot<EncodedState> encodedState;
+    juce::SpinLock encodeLock;
+
+    // Audio thread side. The bank is the last handoff with the partial parameters applied
+    TableBank::State audioBank;
+    TableMorpher morpher;
+    uint32_t lastBankVersion = 0;
+    uint32_t lastComboVersion = 0;
+    uint32_t lastTransitionVersion = 0;
+    uint32_t lastLinkGroupId = 0;
+    TableBank::MorphParameters lastOwnMorph;
+    TableCrossfader crossfader;
+
+    EditHistory editHistory;
+    PresetLibrary presetLibrary;
+    PresetSaveQueue presetSaveQueue;
+
+    HarmonicGenerator harmonicGenerator;
+    PitchTracker pitchTracker; // audio to MIDI build only
+    UmpBuffer umpOutput;
+    AdditiveSynth additiveSynth; // synth build only
+    std::atomic<float>* morphParam = nullptr;
+    std::atomic<float>* morphModeParam = nullptr;
+    std::atomic<float>* morphCurveParam = nullptr;
+    std::atomic<float>* morphXParam = nullptr;
+    std::atomic<float>* morphYParam = nullptr;
+    std::atomic<float>* decimateControllersParam = nullptr;
+    std::atomic<float>* maxVoicesParam = nullptr;
+    std::atomic<float>* maxEventsPerBlockParam = nullptr;
+    std::atomic<float>* stealPolicyParam = nullptr;
+    std::atomic<float>* transitionTimeParam = nullptr;
+    std::atomic<float>* lookaheadParam = nullptr;
+    std::atomic<float>* strumParam = nullptr;
+    std::atomic<float>* humanizeParam = nullptr;
+    std::atomic<float>* midiOutputParam = nullptr;
+    std::array<std::atomic<float>*, HarmonicSeries::numHarmonics> routeParams {};
+
+    // Latency reported in lookahead mode, also the furthest a harmonic can move
+    static constexpr double lookaheadSeconds = 0.05;
+    std::atomic<int> lookaheadLatency { 0 };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginProcessor)
 };
\ No newline at end of file
@@ -1,6 +1,6 @@
 #pragma once
 #include <juce_core/juce_core.h>
-#include <juce_data_structures/juce_data_structures.h>
+#include "PresetStream.h"
 
 struct PresetData
 {
@@ -11,75 +11,48 @@ struct PresetData
 
     void saveToFile(const juce::File& file) const
     {
-        juce::ValueTree preset("PRESET");
-        
-        // Save harm1 data
-        juce::ValueTree harm1Tree("HARM1");
-        for (int i = 0; i < harm1Data.size(); ++i)
-            harm1Tree.setProperty("h" + juce::String(i), harm1Data[i], nullptr);
-        
-        // Save harm2 data
-        juce::ValueTree harm2Tree("HARM2");
-        for (int i = 0; i < harm2Data.size(); ++i)
-            harm2Tree.setProperty("h" + juce::String(i), harm2Data[i], nullptr);
-
-        // Save combo data
-        juce::ValueTree comboTree("COMBO");
-        for (int i = 0; i < comboData.size(); ++i)
-            comboTree.setProperty("h" + juce::String(i), comboData[i], nullptr);
-        
-        // Save morph value
-        preset.setProperty("morphValue", morphValue, nullptr);
-        
-        preset.addChild(harm1Tree, -1, nullptr);
-        preset.addChild(harm2Tree, -1, nullptr);
-        preset.addChild(comboTree, -1, nullptr);
-        
-        if (auto xml = preset.createXml())
-            xml->writeTo(file);
+        PresetWriter::writeToFile(toFields(), file);
     }
 
     static PresetData loadFromFile(const juce::File& file)
     {
-        PresetData data;
-        
-        if (auto xml = juce::XmlDocument::parse(file))
-        {
-            auto preset = juce::ValueTree::fromXml(*xml);
-            
-            auto harm1Tree = preset.getChildWithName("HARM1");
-            if (harm1Tree.isValid())
-            {
-                for (int i = 0; i < 8; ++i)
-                {
-                    auto value = harm1Tree.getProperty("h" + juce::String(i));
-                    data.harm1Data.add(value);
-                }
-            }
-            
-            auto harm2Tree = preset.getChildWithName("HARM2");
-            if (harm2Tree.isValid())
-            {
-                for (int i = 0; i < 8; ++i)
-                {
-                    auto value = harm2Tree.getProperty("h" + juce::String(i));
-                    data.harm2Data.add(value);
-                }
-            }
+        PresetFields fields;
+        juce::MemoryBlock scratch;
+
+        if (! PresetReader::readFile(file, fields, scratch))
+            fields = {};
+
+        return fromFields(fields);
+    }
+
+    PresetFields toFields() const
+    {
+        PresetFields fields;
+        fields.morphValue = morphValue;
+        fields.hasHarm1 = fields.hasHarm2 = fields.hasCombo = true;
 
-            auto comboTree = preset.getChildWithName("COMBO");
-            if (comboTree.isValid())
-            {
-                for (int i = 0; i < 8; ++i)
-                {
-                    auto value = comboTree.getProperty("h" + juce::String(i));
-                    data.comboData.add(value);
-                }
-            }
-            
-            data.morphValue = preset.getProperty("morphValue", 0.0f);
+        for (int i = 0; i < HarmonicSeries::numHarmonics; ++i)
+        {
+            fields.harm1[(size_t) i] = harm1Data[i];
+            fields.harm2[(size_t) i] = harm2Data[i];
+            fields.combo[(size_t) i] = comboData[i];
         }
-        
+
+        return fields;
+    }
+
+    // A missing section stays empty, as with the old ValueTree loader
+    static PresetData fromFields(const PresetFields& fields)
+    {
+        auto toArray = [](const HarmonicTable& table, bool present) {
+            return present ? juce::Array<float>(table.data(), (int) table.size()) : juce::Array<float>();
+        };
+
+        PresetData data;
+        data.harm1Data = toArray(fields.harm1, fields.hasHarm1);
+        data.harm2Data = toArray(fields.harm2, fields.hasHarm2);
+        data.comboData = toArray(fields.combo, fields.hasCombo);
+        data.morphValue = fields.morphValue;
         return data;
     }
-};
\ No newline at end of file
+};
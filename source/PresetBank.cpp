@@ -0,0 +1,180 @@
+#include "PresetBank.h"
+
+namespace
+{
+    constexpr size_t headerSize = 7 * sizeof(juce::uint32);
+    constexpr size_t indexEntrySize = 2 * sizeof(juce::uint32);
+    constexpr size_t recordSize = PresetBank::floatsPerRecord * sizeof(float);
+
+    float readFloat(const char* source)
+    {
+        const auto bits = juce::ByteOrder::littleEndianInt(source);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    void readTable(const char*& source, HarmonicTable& table)
+    {
+        for (auto& value : table)
+        {
+            value = readFloat(source);
+            source += sizeof(float);
+        }
+    }
+
+    bool writeTable(juce::OutputStream& out, const HarmonicTable& table)
+    {
+        for (auto value : table)
+            if (! out.writeFloat(value))
+                return false;
+
+        return true;
+    }
+}
+
+bool PresetBank::open(const juce::File& file)
+{
+    close();
+
+    auto mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    const auto size = mapping->getSize();
+    if (mapping->getData() == nullptr || size < headerSize)
+        return false;
+
+    mappedFile = std::move(mapping);
+
+    const auto count = (size_t) readHeaderValue(2);
+    indexOffset = readHeaderValue(4);
+    namesOffset = readHeaderValue(5);
+    recordsOffset = readHeaderValue(6);
+
+    const bool valid = readHeaderValue(0) == magic
+                       && readHeaderValue(1) == version
+                       && readHeaderValue(3) == (juce::uint32) floatsPerRecord
+                       && indexOffset + count * indexEntrySize <= namesOffset
+                       && namesOffset <= recordsOffset
+                       && recordsOffset + count * recordSize <= size;
+
+    if (! valid)
+    {
+        close();
+        return false;
+    }
+
+    numPresets = (int) count;
+    return true;
+}
+
+void PresetBank::close()
+{
+    mappedFile.reset();
+    numPresets = 0;
+    indexOffset = namesOffset = recordsOffset = 0;
+}
+
+juce::String PresetBank::getName(int index) const
+{
+    if (! juce::isPositiveAndBelow(index, numPresets))
+        return {};
+
+    const char* entry = bytes() + indexOffset + (size_t) index * indexEntrySize;
+    const auto nameOffset = (size_t) juce::ByteOrder::littleEndianInt(entry);
+    const auto nameLength = (size_t) juce::ByteOrder::littleEndianInt(entry + sizeof(juce::uint32));
+
+    if (namesOffset + nameOffset + nameLength > recordsOffset)
+        return {};
+
+    return juce::String::fromUTF8(bytes() + namesOffset + nameOffset, (int) nameLength);
+}
+
+bool PresetBank::getPreset(int index, PresetFields& result) const
+{
+    if (! juce::isPositiveAndBelow(index, numPresets))
+        return false;
+
+    const char* record = bytes() + recordsOffset + (size_t) index * recordSize;
+    readTable(record, result.harm1);
+    readTable(record, result.harm2);
+    readTable(record, result.combo);
+    result.morphValue = readFloat(record);
+    result.hasHarm1 = result.hasHarm2 = result.hasCombo = true;
+    return true;
+}
+
+int PresetBank::indexOf(const juce::String& name) const
+{
+    for (int i = 0; i < numPresets; ++i)
+        if (getName(i) == name)
+            return i;
+
+    return -1;
+}
+
+juce::uint32 PresetBank::readHeaderValue(size_t position) const
+{
+    return juce::ByteOrder::littleEndianInt(bytes() + position * sizeof(juce::uint32));
+}
+
+bool PresetBank::write(const std::vector<Entry>& entries, juce::OutputStream& out)
+{
+    const auto count = entries.size();
+
+    juce::MemoryOutputStream names;
+    std::vector<std::pair<juce::uint32, juce::uint32>> nameRanges;
+    nameRanges.reserve(count);
+
+    for (const auto& entry : entries)
+    {
+        const auto offset = (juce::uint32) names.getDataSize();
+        names << entry.name;
+        nameRanges.emplace_back(offset, (juce::uint32) (names.getDataSize() - offset));
+    }
+
+    // Records start on a float boundary
+    const auto indexStart = headerSize;
+    const auto namesStart = indexStart + count * indexEntrySize;
+    const auto padding = (4 - names.getDataSize() % 4) % 4;
+    const auto recordsStart = namesStart + names.getDataSize() + padding;
+
+    bool ok = out.writeInt((int) magic)
+              && out.writeInt((int) version)
+              && out.writeInt((int) count)
+              && out.writeInt(floatsPerRecord)
+              && out.writeInt((int) indexStart)
+              && out.writeInt((int) namesStart)
+              && out.writeInt((int) recordsStart);
+
+    for (const auto& [offset, length] : nameRanges)
+        ok = ok && out.writeInt((int) offset) && out.writeInt((int) length);
+
+    ok = ok && out.write(names.getData(), names.getDataSize())
+         && out.writeRepeatedByte(0, padding);
+
+    for (const auto& entry : entries)
+    {
+        ok = ok && writeTable(out, entry.fields.harm1)
+             && writeTable(out, entry.fields.harm2)
+             && writeTable(out, entry.fields.combo)
+             && out.writeFloat(entry.fields.morphValue);
+    }
+
+    return ok;
+}
+
+bool PresetBank::write(const std::vector<Entry>& entries, const juce::File& file)
+{
+    juce::TemporaryFile temporary(file, juce::TemporaryFile::useHiddenFile);
+
+    {
+        juce::FileOutputStream out(temporary.getFile());
+        if (! out.openedOk() || ! write(entries, out))
+            return false;
+
+        out.flush();
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temporary.overwriteTargetFileWithTemporary();
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include "PresetStream.h"
+
+// Single file bank of presets, read through a memory mapping.
+//
+// Layout, all little-endian:
+//   header   magic "HPBK", version, preset count, floats per record,
+//            index offset, names offset, records offset (7 x uint32)
+//   index    per preset: name offset and name length into the names block
+//   names    UTF-8 preset names, back to back
+//   records  per preset: harm1, harm2, combo (8 floats each) then morph,
+//            at a fixed stride so preset i sits at recordsOffset + i * stride
+//
+// Nothing is parsed on open beyond the header, so any preset is an O(1) read.
+class PresetBank
+{
+public:
+    static constexpr juce::uint32 magic = 0x4b425048; // "HPBK"
+    static constexpr juce::uint32 version = 1;
+    static constexpr int floatsPerRecord = 3 * HarmonicSeries::numHarmonics + 1;
+
+    struct Entry
+    {
+        juce::String name;
+        PresetFields fields;
+    };
+
+    PresetBank() = default;
+
+    // Maps the file read-only, returns false if it isn't a valid bank
+    bool open(const juce::File& file);
+    void close();
+    bool isOpen() const { return mappedFile != nullptr; }
+
+    int getNumPresets() const { return numPresets; }
+    juce::String getName(int index) const;
+    bool getPreset(int index, PresetFields& result) const;
+    int indexOf(const juce::String& name) const;
+
+    static bool write(const std::vector<Entry>& entries, juce::OutputStream& out);
+    static bool write(const std::vector<Entry>& entries, const juce::File& file);
+
+private:
+    juce::uint32 readHeaderValue(size_t position) const;
+    const char* bytes() const { return static_cast<const char*>(mappedFile->getData()); }
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    int numPresets = 0;
+    size_t indexOffset = 0;
+    size_t namesOffset = 0;
+    size_t recordsOffset = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetBank)
+};
@@ -0,0 +1,196 @@
+#include "PresetLibrary.h"
+
+PresetLibrary::Index::Index(int size)
+    : numPresets(size),
+      names((size_t) size),
+      files((size_t) size)
+{
+    constexpr size_t alignment = 32;
+    storage.calloc((size_t) size * vectorSize * sizeof(float) + alignment);
+    vectors = reinterpret_cast<float*>(juce::snapPointerToAlignment(storage.get(), alignment));
+}
+
+juce::String PresetLibrary::Index::getName(int index) const
+{
+    return juce::isPositiveAndBelow(index, numPresets) ? names[(size_t) index] : juce::String();
+}
+
+bool PresetLibrary::Index::loadPreset(int index, PresetFields& result) const
+{
+    if (! juce::isPositiveAndBelow(index, numPresets))
+        return false;
+
+    // Bank presets come first
+    if (bank != nullptr && index < bank->getNumPresets())
+        return bank->getPreset(index, result);
+
+    juce::MemoryBlock scratch;
+    return PresetReader::readFile(files[(size_t) index], result, scratch);
+}
+
+//==============================================================================
+PresetLibrary::PresetLibrary() = default;
+
+PresetLibrary::~PresetLibrary()
+{
+    tasks.stop();
+}
+
+void PresetLibrary::scan(const juce::File& directory, const juce::File& bankFile, std::function<void()> onFinished)
+{
+    scanning = true;
+    const int generation = ++scanGeneration;
+
+    tasks.addJob([this, directory, bankFile, onFinished, generation]() {
+        auto files = directory.findChildFiles(juce::File::findFiles, true, "*.preset");
+        files.sort();
+
+        auto bank = std::make_shared<PresetBank>();
+        if (! bank->open(bankFile))
+            bank.reset();
+
+        const int numBankPresets = bank != nullptr ? bank->getNumPresets() : 0;
+        auto newIndex = std::make_shared<Index>(numBankPresets + files.size());
+        newIndex->bank = bank;
+
+        // Bank records are already decoded, so they go in straight away
+        PresetFields fields;
+        for (int i = 0; i < numBankPresets; ++i)
+        {
+            newIndex->names[(size_t) i] = bank->getName(i);
+            if (bank->getPreset(i, fields))
+                std::copy(fields.combo.begin(), fields.combo.end(), newIndex->vectors + (size_t) i * vectorSize);
+        }
+
+        for (int i = 0; i < files.size(); ++i)
+        {
+            const auto slot = (size_t) (numBankPresets + i);
+            newIndex->names[slot] = files[i].getFileNameWithoutExtension();
+            newIndex->files[slot] = files[i];
+        }
+
+        // Files are parsed in parallel, each chunk into its own slice of the index.
+        // The batch only reports back while this library is alive
+        const int numChunks = juce::jmin(BackgroundTasks::getNumThreads(), files.size());
+        auto batch = tasks.startBatch(numChunks, [this, newIndex, onFinished, generation](int) {
+            if (scanGeneration != generation)
+                return;
+
+            index = newIndex;
+            scanning = false;
+
+            if (onFinished != nullptr)
+                onFinished();
+        });
+
+        for (int chunk = 0; chunk < numChunks; ++chunk)
+        {
+            const int begin = files.size() * chunk / numChunks;
+            const int end = files.size() * (chunk + 1) / numChunks;
+
+            tasks.addJob([newIndex, numBankPresets, begin, end, batch]() {
+                juce::MemoryBlock scratch;
+                PresetFields presetFields;
+
+                for (int i = numBankPresets + begin; i < numBankPresets + end; ++i)
+                    if (PresetReader::readFile(newIndex->files[(size_t) i], presetFields, scratch))
+                        std::copy(presetFields.combo.begin(), presetFields.combo.end(), newIndex->vectors + (size_t) i * vectorSize);
+
+                batch->itemDone(true);
+            });
+        }
+    });
+}
+
+void PresetLibrary::findSimilar(const HarmonicTable& query, int k, std::function<void(const Results&)> onUpdate)
+{
+    auto results = std::make_shared<Results>();
+    results->index = index;
+
+    const int generation = ++searchGeneration;
+    const int numPresets = index != nullptr ? index->getNumPresets() : 0;
+
+    if (numPresets == 0 || k <= 0)
+    {
+        results->finished = true;
+        onUpdate(*results);
+        return;
+    }
+
+    results->matches.reserve((size_t) k + 1);
+
+    // Small libraries aren't worth splitting up
+    const int numChunks = juce::jlimit(1, BackgroundTasks::getNumThreads(), (numPresets + minPresetsPerChunk - 1) / minPresetsPerChunk);
+    auto remaining = std::make_shared<int>(numChunks);
+    juce::WeakReference<PresetLibrary> self(this);
+
+    for (int chunk = 0; chunk < numChunks; ++chunk)
+    {
+        const int begin = (int) ((juce::int64) numPresets * chunk / numChunks);
+        const int end = (int) ((juce::int64) numPresets * (chunk + 1) / numChunks);
+
+        tasks.addJob([this, self, searchIndex = index, query, k, begin, end, generation, results, remaining, onUpdate]() {
+            if (searchGeneration != generation)
+                return;
+
+            std::vector<Match> best;
+            best.reserve((size_t) k + 1);
+            findNearest(searchIndex->getVectors(), begin, end, query.data(), k, best);
+
+            // Merging happens on the message thread, so results needs no lock
+            juce::MessageManager::callAsync([self, best = std::move(best), k, generation, results, remaining, onUpdate]() {
+                if (self == nullptr || self->searchGeneration != generation)
+                    return;
+
+                for (const auto& match : best)
+                    insertMatch(results->matches, k, match);
+
+                results->finished = --*remaining == 0;
+                onUpdate(*results);
+            });
+        });
+    }
+}
+
+void PresetLibrary::findNearest(const float* vectors, int begin, int end, const float* query, int k, std::vector<Match>& best)
+{
+    for (int i = begin; i < end; ++i)
+    {
+        const float* vector = vectors + (size_t) i * vectorSize;
+
+        // Fixed length, so this unrolls and vectorises
+        float distance = 0.0f;
+        for (int h = 0; h < vectorSize; ++h)
+        {
+            const float difference = vector[h] - query[h];
+            distance += difference * difference;
+        }
+
+        if ((int) best.size() < k || distance < best.back().distance)
+            insertMatch(best, k, { i, distance });
+    }
+}
+
+std::shared_ptr<const PresetLibrary::Index> PresetLibrary::createIndex(const std::vector<PresetBank::Entry>& entries)
+{
+    auto newIndex = std::make_shared<Index>((int) entries.size());
+
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        newIndex->names[i] = entries[i].name;
+        std::copy(entries[i].fields.combo.begin(), entries[i].fields.combo.end(), newIndex->vectors + i * vectorSize);
+    }
+
+    return newIndex;
+}
+
+void PresetLibrary::insertMatch(std::vector<Match>& best, int k, Match match)
+{
+    auto position = std::upper_bound(best.begin(), best.end(), match.distance,
+        [](float distance, const Match& other) { return distance < other.distance; });
+
+    best.insert(position, match);
+
+    if ((int) best.size() > k)
+        best.pop_back();
+}
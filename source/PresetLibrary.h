@@ -0,0 +1,90 @@
+#pragma once
+#include "BackgroundTasks.h"
+#include "PresetBank.h"
+
+// Index of every preset we know about, for "find similar".
+//
+// Each preset's combo table is decoded once into a flat, 32-byte aligned
+// float array with one 8-float vector per preset, so a search is a
+// straight pass over contiguous memory. Scanning and searching run in
+// chunks on the shared BackgroundTasks pool; results come back on the
+// message thread.
+//
+// Everything except the static kernel is message thread only.
+class PresetLibrary
+{
+public:
+    static constexpr int vectorSize = HarmonicSeries::numHarmonics;
+
+    struct Match
+    {
+        int index = -1;
+        float distance = 0.0f; // squared euclidean distance between combo tables
+    };
+
+    // An immutable snapshot, searches keep theirs alive while they run
+    class Index
+    {
+    public:
+        explicit Index(int numPresets);
+
+        int getNumPresets() const { return numPresets; }
+        juce::String getName(int index) const;
+        bool isBankPreset(int index) const { return bank != nullptr && juce::isPositiveAndBelow(index, bank->getNumPresets()); }
+        bool loadPreset(int index, PresetFields& result) const;
+        const float* getVectors() const { return vectors; }
+
+    private:
+        friend class PresetLibrary;
+
+        int numPresets = 0;
+        juce::HeapBlock<char> storage;
+        float* vectors = nullptr;
+        std::vector<juce::String> names;
+        std::vector<juce::File> files; // empty for bank presets
+        std::shared_ptr<PresetBank> bank;
+    };
+
+    struct Results
+    {
+        std::shared_ptr<const Index> index;
+        std::vector<Match> matches; // nearest first
+        bool finished = false;
+    };
+
+    PresetLibrary();
+    ~PresetLibrary();
+
+    // Rebuilds the index in the background from a preset bank plus every
+    // .preset file below directory. onFinished runs on the message thread.
+    void scan(const juce::File& directory, const juce::File& bankFile, std::function<void()> onFinished = nullptr);
+    bool isScanning() const { return scanning; }
+
+    std::shared_ptr<const Index> getIndex() const { return index; }
+
+    // Finds the k presets whose combo tables are closest to query.
+    // onUpdate is called as each chunk of the library finishes, with the best
+    // matches so far, and a last time with finished set. A newer search
+    // supersedes an older one, which then stops reporting.
+    void findSimilar(const HarmonicTable& query, int k, std::function<void(const Results&)> onUpdate);
+
+    // Keeps best as the k nearest of vectors [begin, end), sorted nearest first
+    static void findNearest(const float* vectors, int begin, int end, const float* query, int k, std::vector<Match>& best);
+
+    // Builds an index straight from entries, for tests and benchmarks
+    static std::shared_ptr<const Index> createIndex(const std::vector<PresetBank::Entry>& entries);
+
+private:
+    static constexpr int minPresetsPerChunk = 4096;
+
+    static void insertMatch(std::vector<Match>& best, int k, Match match);
+
+    BackgroundTasks tasks;
+    std::shared_ptr<const Index> index;
+    bool scanning = false;
+    int scanGeneration = 0;
+    std::atomic<int> searchGeneration { 0 }; // read by search jobs to drop superseded work
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(PresetLibrary)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetLibrary)
+};
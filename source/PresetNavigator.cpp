@@ -0,0 +1,158 @@
+#include "PresetNavigator.h"
+
+PresetNavigator::PresetNavigator() = default;
+
+PresetNavigator::~PresetNavigator()
+{
+    tasks.stop();
+}
+
+void PresetNavigator::setFolder(const juce::File& folder)
+{
+    currentFile = juce::File();
+    listFolder(folder);
+}
+
+void PresetNavigator::setCurrentPreset(const juce::File& file)
+{
+    currentFile = file;
+    pendingFile = juce::File();
+
+    // It may just have been saved over
+    for (auto& entry : cache)
+        if (entry.file == file)
+            entry.file = juce::File();
+
+    listFolder(file.getParentDirectory());
+}
+
+void PresetNavigator::step(int delta)
+{
+    if (files.isEmpty())
+        return;
+
+    const int numFiles = files.size();
+    const int index = files.indexOf(currentFile);
+    const int from = index >= 0 ? index : (delta > 0 ? -1 : numFiles);
+
+    currentFile = files[((from + delta) % numFiles + numFiles) % numFiles];
+
+    if (auto* cached = findCached(currentFile))
+    {
+        pendingFile = juce::File();
+        if (onPresetLoaded != nullptr)
+            onPresetLoaded(cached->file, cached->fields);
+    }
+    else
+    {
+        pendingFile = currentFile;
+    }
+
+    prefetch();
+}
+
+void PresetNavigator::listFolder(const juce::File& folder)
+{
+    const int generation = ++listGeneration;
+    juce::WeakReference<PresetNavigator> self(this);
+
+    tasks.addJob([self, folder, generation]() {
+        auto list = folder.findChildFiles(juce::File::findFiles, false, "*.preset");
+        list.sort();
+
+        juce::MessageManager::callAsync([self, list, generation]() {
+            if (self == nullptr || self->listGeneration != generation)
+                return;
+
+            self->files = list;
+            self->prefetch();
+        });
+    });
+}
+
+void PresetNavigator::prefetch()
+{
+    const int numFiles = files.size();
+    const int index = files.indexOf(currentFile);
+    if (numFiles == 0)
+        return;
+
+    juce::WeakReference<PresetNavigator> self(this);
+
+    // Nearest first, the current one only matters if a step is waiting for it
+    for (int offset : { 0, 1, -1, 2, -2 })
+    {
+        const int from = index >= 0 ? index : (offset > 0 ? -1 : numFiles);
+        if (index < 0 && offset == 0)
+            continue;
+
+        const auto file = files[((from + offset) % numFiles + numFiles) % numFiles];
+        if (findCached(file) != nullptr || requested.contains(file))
+            continue;
+
+        requested.add(file);
+        tasks.addJob([self, file]() {
+            PresetFields fields;
+            juce::MemoryBlock scratch;
+            const bool ok = PresetReader::readFile(file, fields, scratch);
+
+            juce::MessageManager::callAsync([self, file, fields, ok]() {
+                if (self == nullptr)
+                    return;
+
+                self->requested.removeFirstMatchingValue(file);
+
+                if (ok)
+                    self->decoded(file, fields);
+                else if (self->pendingFile == file)
+                    self->pendingFile = juce::File();
+            });
+        });
+    }
+}
+
+void PresetNavigator::decoded(const juce::File& file, const PresetFields& fields)
+{
+    // Reuse an empty slot or one that has drifted out of reach before
+    // falling back to round robin
+    auto isNearCurrent = [this](const juce::File& cachedFile) {
+        const int numFiles = files.size();
+        const int index = files.indexOf(currentFile);
+        const int other = files.indexOf(cachedFile);
+        if (index < 0 || other < 0)
+            return false;
+
+        const int distance = std::abs(index - other);
+        return juce::jmin(distance, numFiles - distance) <= prefetchDistance;
+    };
+
+    auto slot = cache.end();
+    for (auto it = cache.begin(); it != cache.end() && slot == cache.end(); ++it)
+        if (it->file == juce::File() || ! isNearCurrent(it->file))
+            slot = it;
+
+    if (slot == cache.end())
+    {
+        slot = cache.begin() + (std::ptrdiff_t) nextCacheSlot;
+        nextCacheSlot = (nextCacheSlot + 1) % cache.size();
+    }
+
+    slot->file = file;
+    slot->fields = fields;
+
+    if (pendingFile == file)
+    {
+        pendingFile = juce::File();
+        if (onPresetLoaded != nullptr)
+            onPresetLoaded(file, fields);
+    }
+}
+
+const PresetNavigator::CachedPreset* PresetNavigator::findCached(const juce::File& file) const
+{
+    for (const auto& entry : cache)
+        if (entry.file != juce::File() && entry.file == file)
+            return &entry;
+
+    return nullptr;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <juce_events/juce_events.h>
+#include "BackgroundTasks.h"
+#include "PresetStream.h"
+
+// Previous/next stepping through the presets in a folder.
+//
+// The folder listing and the presets either side of the current one are
+// read and decoded on the shared BackgroundTasks pool ahead of time, so a
+// step that lands on a decoded preset applies straight away with no disk
+// access. A step that gets ahead of the prefetch is delivered as soon as
+// its preset has been decoded.
+//
+// Message thread only, results arrive through onPresetLoaded.
+class PresetNavigator
+{
+public:
+    PresetNavigator();
+    ~PresetNavigator();
+
+    // Steps through folder, starting before its first preset
+    void setFolder(const juce::File& folder);
+
+    // Makes file the current preset, e.g. after loading or saving it elsewhere
+    void setCurrentPreset(const juce::File& file);
+
+    // Moves delta presets along, wrapping around the folder
+    void step(int delta);
+
+    juce::File getCurrentPreset() const { return currentFile; }
+
+    std::function<void(const juce::File& file, const PresetFields& fields)> onPresetLoaded;
+
+private:
+    struct CachedPreset
+    {
+        juce::File file;
+        PresetFields fields;
+    };
+
+    static constexpr int prefetchDistance = 2;
+    static constexpr int cacheSize = 2 * prefetchDistance + 1;
+
+    void listFolder(const juce::File& folder);
+    void prefetch();
+    void decoded(const juce::File& file, const PresetFields& fields);
+    const CachedPreset* findCached(const juce::File& file) const;
+
+    BackgroundTasks tasks;
+    juce::Array<juce::File> files;
+    juce::File currentFile;
+    int listGeneration = 0;
+    juce::File pendingFile;
+
+    // Small round robin cache of decoded presets
+    std::array<CachedPreset, cacheSize> cache;
+    size_t nextCacheSlot = 0;
+    juce::Array<juce::File> requested;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(PresetNavigator)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetNavigator)
+};
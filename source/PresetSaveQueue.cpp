@@ -0,0 +1,118 @@
+#include "PresetSaveQueue.h"
+
+PresetSaveQueue::PresetSaveQueue() = default;
+
+PresetSaveQueue::~PresetSaveQueue()
+{
+    // A write that hasn't started yet is dropped from the pool and done here
+    tasks.stop();
+    paused = false;
+
+    while (writeNext())
+    {
+    }
+}
+
+void PresetSaveQueue::save(const juce::File& file, const PresetFields& fields, Callback onFinished)
+{
+    bool startWriting = false;
+    {
+        const juce::ScopedLock sl(lock);
+
+        auto existing = std::find_if(pending.begin(), pending.end(), [&file](const Pending& p) { return p.file == file; });
+        if (existing == pending.end())
+            existing = pending.insert(pending.end(), Pending { file, {}, {} });
+
+        existing->fields = fields;
+        if (onFinished != nullptr)
+            existing->callbacks.push_back(std::move(onFinished));
+
+        // One job at a time, so two saves of a file can't land out of order
+        startWriting = ! writing && ! paused;
+        writing = writing || startWriting;
+    }
+
+    if (startWriting)
+        tasks.addJob([this] { writeAll(); });
+}
+
+void PresetSaveQueue::pause()
+{
+    const juce::ScopedLock sl(lock);
+    paused = true;
+}
+
+void PresetSaveQueue::resume()
+{
+    bool startWriting = false;
+    {
+        const juce::ScopedLock sl(lock);
+        paused = false;
+        startWriting = ! writing && ! pending.empty();
+        writing = writing || startWriting;
+    }
+
+    if (startWriting)
+        tasks.addJob([this] { writeAll(); });
+}
+
+void PresetSaveQueue::waitUntilWritten()
+{
+    for (;;)
+    {
+        {
+            const juce::ScopedLock sl(lock);
+            if (! writing)
+                return;
+        }
+
+        idle.wait(-1);
+    }
+}
+
+void PresetSaveQueue::writeAll()
+{
+    for (;;)
+    {
+        while (writeNext())
+        {
+        }
+
+        // A save that came in after the last writeNext() is picked up here
+        const juce::ScopedLock sl(lock);
+        if (pending.empty() || paused)
+        {
+            writing = false;
+            idle.signal();
+            return;
+        }
+    }
+}
+
+bool PresetSaveQueue::writeNext()
+{
+    Pending next;
+    {
+        const juce::ScopedLock sl(lock);
+        if (pending.empty() || paused)
+            return false;
+
+        next = std::move(pending.front());
+        pending.erase(pending.begin());
+    }
+
+    const bool saved = next.file.getParentDirectory().createDirectory().wasOk()
+                    && PresetWriter::writeToFile(next.fields, next.file);
+    if (saved)
+        ++numWritten;
+
+    if (! next.callbacks.empty())
+    {
+        juce::MessageManager::callAsync([file = next.file, saved, callbacks = std::move(next.callbacks)]() {
+            for (auto& callback : callbacks)
+                callback(file, saved);
+        });
+    }
+
+    return true;
+}
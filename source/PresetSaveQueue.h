@@ -0,0 +1,60 @@
+#pragma once
+#include <juce_events/juce_events.h>
+#include "BackgroundTasks.h"
+#include "PresetStream.h"
+
+// Writes presets in the background, so a save never blocks the UI on slow
+// or network storage.
+//
+// Writes run on the shared BackgroundTasks pool, one at a time per queue,
+// so an instance that never saves costs no thread at all. Each file is
+// written to a temporary file next to it and renamed over it once complete
+// (PresetWriter::writeToFile), so a crash mid-save can't leave a truncated
+// preset. Saving a file that is still waiting to be written replaces what
+// it will be written with, so rapid repeated saves cost one write.
+// Everything queued is written before the queue is destroyed.
+//
+// save() is message thread only. Callbacks run on the message thread.
+class PresetSaveQueue
+{
+public:
+    using Callback = std::function<void(const juce::File& file, bool saved)>;
+
+    PresetSaveQueue();
+    ~PresetSaveQueue();
+
+    void save(const juce::File& file, const PresetFields& fields, Callback onFinished = nullptr);
+
+    // Blocks until everything saved so far has been written, or has failed.
+    // Saves held back by pause() aren't waited for.
+    void waitUntilWritten();
+
+    // Holds back writes that haven't started, so saves queued meanwhile
+    // coalesce, until resume(). The destructor still writes them.
+    void pause();
+    void resume();
+
+    // Presets actually written, so fewer than saves when some were coalesced
+    int getNumWritten() const { return numWritten; }
+
+private:
+    struct Pending
+    {
+        juce::File file;
+        PresetFields fields;
+        std::vector<Callback> callbacks;
+    };
+
+    void writeAll();
+    bool writeNext();
+
+    juce::CriticalSection lock;
+    std::vector<Pending> pending;
+    bool writing = false;
+    bool paused = false;
+    juce::WaitableEvent idle;
+    std::atomic<int> numWritten { 0 };
+    BackgroundTasks tasks;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetSaveQueue)
+};
@@ -0,0 +1,255 @@
+#include "PresetStream.h"
+
+namespace
+{
+    enum class Section
+    {
+        preset,
+        harm1,
+        harm2,
+        combo,
+        other
+    };
+
+    bool isWhitespace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    bool isNameCharacter(char c)
+    {
+        return ! isWhitespace(c) && c != '=' && c != '/' && c != '>' && c != '<';
+    }
+
+    bool matches(const char* begin, const char* end, const char* name)
+    {
+        const auto length = std::strlen(name);
+        return (size_t) (end - begin) == length && std::memcmp(begin, name, length) == 0;
+    }
+
+    const char* skipPast(const char* p, const char* end, const char* terminator)
+    {
+        const auto length = std::strlen(terminator);
+
+        for (; p + length <= end; ++p)
+            if (std::memcmp(p, terminator, length) == 0)
+                return p + length;
+
+        return end;
+    }
+
+    Section classify(const char* begin, const char* end)
+    {
+        if (matches(begin, end, "PRESET")) return Section::preset;
+        if (matches(begin, end, "HARM1"))  return Section::harm1;
+        if (matches(begin, end, "HARM2"))  return Section::harm2;
+        if (matches(begin, end, "COMBO"))  return Section::combo;
+        return Section::other;
+    }
+
+    // Same leniency as var -> float: surrounding spaces are fine, junk reads as 0
+    float parseFloat(const char* begin, const char* end)
+    {
+        while (begin < end && isWhitespace(*begin))
+            ++begin;
+        if (begin < end && *begin == '+')
+            ++begin;
+
+        // The value isn't null terminated in the file, so it's copied out first
+        char text[64];
+        const auto length = (size_t) juce::jmin(end - begin, (std::ptrdiff_t) sizeof(text) - 1);
+        std::memcpy(text, begin, length);
+        text[length] = 0;
+
+        juce::CharPointer_UTF8 pointer(text);
+        return (float) juce::CharacterFunctions::readDoubleValue(pointer);
+    }
+
+    // "h0" to "h7", or -1
+    int harmonicIndex(const char* begin, const char* end)
+    {
+        if (end - begin != 2 || begin[0] != 'h')
+            return -1;
+
+        const int index = begin[1] - '0';
+        return juce::isPositiveAndBelow(index, HarmonicSeries::numHarmonics) ? index : -1;
+    }
+
+    void writeFloat(juce::OutputStream& out, float value)
+    {
+        // Locale independent, and enough digits to read back to the same float
+        out << juce::serialiseDouble((double) value);
+    }
+
+    void writeSection(juce::OutputStream& out, const char* name, const HarmonicTable& table)
+    {
+        out << "  <" << name;
+
+        for (size_t i = 0; i < table.size(); ++i)
+        {
+            out << " h" << (char) ('0' + i) << "=\"";
+            writeFloat(out, table[i]);
+            out << '"';
+        }
+
+        out << "/>\r\n";
+    }
+}
+
+bool PresetReader::parse(const char* data, size_t numBytes, PresetFields& result)
+{
+    result = {};
+    bool foundPreset = false;
+
+    const char* p = data;
+    const char* end = data + numBytes;
+
+    while (p < end)
+    {
+        p = static_cast<const char*>(std::memchr(p, '<', (size_t) (end - p)));
+        if (p == nullptr)
+            break;
+
+        ++p;
+        if (p >= end)
+            break;
+
+        // Declarations, comments, doctypes and closing tags carry nothing we need
+        if (*p == '?')
+        {
+            p = skipPast(p, end, "?>");
+            continue;
+        }
+
+        if (end - p >= 3 && std::memcmp(p, "!--", 3) == 0)
+        {
+            p = skipPast(p, end, "-->");
+            continue;
+        }
+
+        if (*p == '!' || *p == '/')
+        {
+            p = skipPast(p, end, ">");
+            continue;
+        }
+
+        const char* nameStart = p;
+        while (p < end && isNameCharacter(*p))
+            ++p;
+
+        const auto section = classify(nameStart, p);
+        HarmonicTable* table = nullptr;
+
+        switch (section)
+        {
+            case Section::preset: foundPreset = true; break;
+            case Section::harm1:  result.hasHarm1 = true; table = &result.harm1; break;
+            case Section::harm2:  result.hasHarm2 = true; table = &result.harm2; break;
+            case Section::combo:  result.hasCombo = true; table = &result.combo; break;
+            case Section::other:  break;
+        }
+
+        // Attributes up to the end of the start tag
+        while (p < end)
+        {
+            while (p < end && isWhitespace(*p))
+                ++p;
+
+            if (p >= end)
+                break;
+
+            if (*p == '/' || *p == '>')
+            {
+                p = skipPast(p, end, ">");
+                break;
+            }
+
+            const char* attributeStart = p;
+            while (p < end && isNameCharacter(*p))
+                ++p;
+            const char* attributeEnd = p;
+
+            while (p < end && isWhitespace(*p))
+                ++p;
+
+            if (p >= end || *p != '=')
+                break;
+
+            ++p;
+            while (p < end && isWhitespace(*p))
+                ++p;
+
+            if (p >= end || (*p != '"' && *p != '\''))
+                break;
+
+            const char quote = *p++;
+            const char* valueStart = p;
+            const char* valueEnd = static_cast<const char*>(std::memchr(p, quote, (size_t) (end - p)));
+            if (valueEnd == nullptr)
+                return foundPreset;
+
+            if (table != nullptr)
+            {
+                const int index = harmonicIndex(attributeStart, attributeEnd);
+                if (index >= 0)
+                    (*table)[(size_t) index] = parseFloat(valueStart, valueEnd);
+            }
+            else if (section == Section::preset && matches(attributeStart, attributeEnd, "morphValue"))
+            {
+                result.morphValue = parseFloat(valueStart, valueEnd);
+            }
+
+            p = valueEnd + 1;
+        }
+    }
+
+    return foundPreset;
+}
+
+bool PresetReader::readFile(const juce::File& file, PresetFields& result, juce::MemoryBlock& scratch)
+{
+    juce::FileInputStream stream(file);
+    if (! stream.openedOk())
+        return false;
+
+    const auto length = (size_t) juce::jmax((juce::int64) 0, stream.getTotalLength());
+    scratch.ensureSize(length);
+
+    const auto numRead = stream.read(scratch.getData(), (int) length);
+    return parse(static_cast<const char*>(scratch.getData()), (size_t) juce::jmax(0, numRead), result);
+}
+
+void PresetWriter::write(const PresetFields& fields, juce::OutputStream& out)
+{
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n\r\n<PRESET morphValue=\"";
+    writeFloat(out, fields.morphValue);
+    out << "\">\r\n";
+
+    writeSection(out, "HARM1", fields.harm1);
+    writeSection(out, "HARM2", fields.harm2);
+    writeSection(out, "COMBO", fields.combo);
+
+    out << "</PRESET>\r\n";
+}
+
+bool PresetWriter::writeToFile(const PresetFields& fields, const juce::File& file)
+{
+    juce::MemoryOutputStream out(1024);
+    write(fields, out);
+
+    // The whole preset is flushed to disk next to the target and then renamed
+    // over it, so a crash part way through leaves the old file intact. The
+    // temporary file is hidden, or a library scan meanwhile would list it
+    juce::TemporaryFile temp(file, juce::TemporaryFile::useHiddenFile);
+    {
+        juce::FileOutputStream stream(temp.getFile());
+        if (! stream.openedOk() || ! stream.write(out.getData(), out.getDataSize()))
+            return false;
+
+        stream.flush();
+        if (stream.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
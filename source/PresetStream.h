@@ -0,0 +1,42 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include "HarmonicTable.h"
+
+// Everything a .preset file holds, in fixed storage
+struct PresetFields
+{
+    HarmonicTable harm1 {};
+    HarmonicTable harm2 {};
+    HarmonicTable combo {};
+    float morphValue = 0.0f;
+
+    // Older files may lack a section, which loads as an empty table
+    bool hasHarm1 = false;
+    bool hasHarm2 = false;
+    bool hasCombo = false;
+};
+
+// Single pass reader for .preset files.
+//
+// Walks the raw bytes once and writes attributes straight into
+// PresetFields, without building an XmlElement or ValueTree and without
+// composing "h0".."h7" attribute names. Accepts everything the old
+// XmlDocument path produced: an XML declaration, comments, either quote
+// style and elements in any order. Unknown elements and attributes are skipped.
+class PresetReader
+{
+public:
+    // Returns false when no PRESET element was found
+    static bool parse(const char* data, size_t numBytes, PresetFields& result);
+
+    // scratch is reused between calls, so bulk imports don't allocate per file
+    static bool readFile(const juce::File& file, PresetFields& result, juce::MemoryBlock& scratch);
+};
+
+// Writes the same layout the ValueTree based writer used to produce
+class PresetWriter
+{
+public:
+    static void write(const PresetFields& fields, juce::OutputStream& out);
+    static bool writeToFile(const PresetFields& fields, const juce::File& file);
+};
@@ -0,0 +1,376 @@
+#include "SampleAnalyser.h"
+#include "PitchTracker.h"
+#include "PresetStream.h"
+#include <numeric>
+
+// One file being analysed. The runs add into sums under the lock and post
+// the running average from inside it, so updates arrive in order.
+struct SampleAnalyser::Analysis
+{
+    juce::File file;
+    Options options;
+    juce::AudioFormatManager* formats = nullptr;
+    std::function<void(const Result&)> onUpdate;
+    std::atomic<bool> cancelled { false };
+
+    float fundamental = 0.0f;
+    int numWindows = 0;
+
+    std::mutex lock;
+    Magnitudes sums {};
+    int numCounted = 0;
+    int windowsDone = 0;
+
+    static void post(const std::shared_ptr<Analysis>& analysis, const Result& result)
+    {
+        juce::MessageManager::callAsync([analysis, result]() {
+            if (! analysis->cancelled)
+                analysis->onUpdate(result);
+        });
+    }
+};
+
+// One item per file
+struct SampleAnalyser::Batch : BackgroundTasks::Batch
+{
+    juce::File destination;
+    juce::AudioFormatManager* formats = nullptr;
+};
+
+SampleAnalyser::SampleAnalyser()
+{
+    formats.registerBasicFormats();
+}
+
+SampleAnalyser::~SampleAnalyser()
+{
+    cancel();
+    tasks.stop();
+}
+
+void SampleAnalyser::analyse(const juce::File& file, std::function<void(const Result&)> onUpdate)
+{
+    cancel();
+
+    auto analysis = std::make_shared<Analysis>();
+    analysis->file = file;
+    analysis->formats = &formats;
+    analysis->onUpdate = std::move(onUpdate);
+    current = analysis;
+
+    tasks.addJob([this, analysis]() { pitchTask(analysis, tasks); });
+}
+
+void SampleAnalyser::cancel()
+{
+    if (current != nullptr)
+        current->cancelled = true;
+
+    current.reset();
+}
+
+void SampleAnalyser::pitchTask(const std::shared_ptr<Analysis>& analysis, BackgroundTasks& tasks)
+{
+    if (analysis->cancelled)
+        return;
+
+    std::unique_ptr<juce::AudioFormatReader> reader(analysis->formats->createReaderFor(analysis->file));
+    if (reader != nullptr)
+        analysis->fundamental = findFundamental(*reader, analysis->options);
+
+    if (analysis->fundamental <= 0.0f)
+    {
+        Result result;
+        result.finished = true;
+        Analysis::post(analysis, result);
+        return;
+    }
+
+    analysis->numWindows = getNumWindows(reader->lengthInSamples, analysis->options);
+
+    // The runs only start once the pitch is known, and land in any order
+    const int windowsPerTask = juce::jmax(1, analysis->options.windowsPerTask);
+    for (int first = 0; first < analysis->numWindows && ! analysis->cancelled; first += windowsPerTask)
+    {
+        const int last = juce::jmin(analysis->numWindows, first + windowsPerTask);
+        tasks.addJob([analysis, first, last]() { measureTask(analysis, first, last); });
+    }
+}
+
+void SampleAnalyser::measureTask(const std::shared_ptr<Analysis>& analysis, int firstWindow, int lastWindow)
+{
+    if (analysis->cancelled)
+        return;
+
+    // Readers aren't thread safe, so every run opens its own
+    Magnitudes sums {};
+    int numCounted = 0;
+    if (std::unique_ptr<juce::AudioFormatReader> reader { analysis->formats->createReaderFor(analysis->file) })
+        numCounted = measureRun(*reader, analysis->fundamental, analysis->options, firstWindow, lastWindow, sums);
+
+    const std::scoped_lock lock(analysis->lock);
+    for (size_t h = 0; h < sums.size(); ++h)
+        analysis->sums[h] += sums[h];
+
+    analysis->numCounted += numCounted;
+    analysis->windowsDone += lastWindow - firstWindow;
+
+    Result result;
+    result.table = toTable(analysis->sums);
+    result.fundamental = analysis->fundamental;
+    result.numWindows = analysis->numCounted;
+    result.progress = (float) analysis->windowsDone / (float) analysis->numWindows;
+    result.finished = analysis->windowsDone == analysis->numWindows;
+    Analysis::post(analysis, result);
+}
+
+void SampleAnalyser::analyseFolder(const juce::File& folder, const juce::File& destination, std::function<void(int numWritten)> onFinished)
+{
+    juce::Array<juce::File> files;
+    for (const auto& file : folder.findChildFiles(juce::File::findFiles, false))
+        if (isAudioFile(file))
+            files.add(file);
+
+    destination.createDirectory();
+
+    auto batch = tasks.startBatch<Batch>(files.size(), std::move(onFinished));
+    batch->destination = destination;
+    batch->formats = &formats;
+
+    // One file per task: the files run side by side, each in runs of windows
+    for (const auto& file : files)
+    {
+        tasks.addJob([batch, file]() {
+            Result result;
+            bool written = false;
+
+            if (analyseFile(*batch->formats, file, {}, result))
+            {
+                PresetFields fields;
+                fields.harm1 = fields.harm2 = fields.combo = result.table;
+                fields.hasHarm1 = fields.hasHarm2 = fields.hasCombo = true;
+
+                written = PresetWriter::writeToFile(fields, batch->destination.getChildFile(file.getFileNameWithoutExtension() + ".preset"));
+            }
+
+            batch->itemDone(written);
+        });
+    }
+}
+
+//==============================================================================
+bool SampleAnalyser::isAudioFile(const juce::File& file)
+{
+    return file.hasFileExtension("wav;aif;aiff;flac;ogg");
+}
+
+float SampleAnalyser::estimateFundamental(const float* samples, int numSamples, double sampleRate)
+{
+    PitchTracker tracker;
+    tracker.setGate(0.001f);
+    tracker.prepare(sampleRate, 512);
+
+    // One estimate per hop, once the tracker's window is full of the file
+    const int hopSize = tracker.getHopSize();
+    std::vector<float> pitched;
+    int numHops = 0;
+    juce::MidiBuffer midi;
+
+    for (int start = 0; start + hopSize <= numSamples; start += hopSize)
+    {
+        const float* channels[] = { samples + start };
+        tracker.process(channels, 1, hopSize, midi);
+        midi.clear();
+
+        if (start + hopSize < tracker.getWindowSize())
+            continue;
+
+        ++numHops;
+        if (tracker.getLastEstimate().frequency > 0.0f)
+            pitched.push_back(tracker.getLastEstimate().frequency);
+    }
+
+    if (pitched.empty() || 4 * (int) pitched.size() < numHops)
+        return 0.0f;
+
+    // The median shrugs off the odd octave error
+    const auto middle = pitched.begin() + (std::ptrdiff_t) (pitched.size() / 2);
+    std::nth_element(pitched.begin(), middle, pitched.end());
+    return *middle;
+}
+
+int SampleAnalyser::measureWindows(const float* samples, int numSamples, double sampleRate, float fundamental, const Options& options,
+                                   const juce::dsp::FFT& fft, const juce::dsp::WindowingFunction<float>& window, float* scratch, Magnitudes& sums)
+{
+    const int size = fft.getSize();
+    const int highestBin = size / 2 - 1;
+    const double binsPerHarmonic = fundamental * size / sampleRate;
+    int numCounted = 0;
+
+    auto measure = [&](const float* x, int length) {
+        const float rms = std::sqrt(std::inner_product(x, x + length, x, 0.0f) / (float) size);
+        if (rms < options.gateLevel)
+            return;
+
+        std::fill(std::copy(x, x + length, scratch), scratch + 2 * size, 0.0f);
+        window.multiplyWithWindowingTable(scratch, (size_t) size);
+        fft.performFrequencyOnlyForwardTransform(scratch, true);
+
+        // The strongest bin within about half a semitone of each harmonic,
+        // which also covers slightly stretched partials
+        for (size_t h = 0; h < sums.size(); ++h)
+        {
+            const double centre = (double) (h + 1) * binsPerHarmonic;
+            const double width = juce::jmax(2.0, centre * 0.03);
+            const int low = juce::jmax(1, (int) std::floor(centre - width));
+            const int high = juce::jmin(highestBin, (int) std::ceil(centre + width));
+
+            if (low <= high)
+                sums[h] += interpolatePeak(scratch, (int) (std::max_element(scratch + low, scratch + high + 1) - scratch));
+        }
+
+        ++numCounted;
+    };
+
+    // A file shorter than one window is measured zero padded
+    if (numSamples < size)
+        measure(samples, numSamples);
+    else
+        for (int start = 0; start + size <= numSamples; start += size / 2)
+            measure(samples + start, size);
+
+    return numCounted;
+}
+
+double SampleAnalyser::interpolatePeak(const float* magnitudes, int bin)
+{
+    // A Hann peak is close to a parabola in log magnitude, and its vertex
+    // undoes the up to 1.4 dB lost when a partial falls between two bins
+    const double left = std::log(magnitudes[bin - 1] + 1.0e-12);
+    const double centre = std::log(magnitudes[bin] + 1.0e-12);
+    const double right = std::log(magnitudes[bin + 1] + 1.0e-12);
+
+    const double denominator = left - 2.0 * centre + right;
+    if (denominator >= 0.0)
+        return magnitudes[bin];
+
+    const double shift = juce::jlimit(-0.5, 0.5, 0.5 * (left - right) / denominator);
+    return std::exp(centre - 0.25 * (left - right) * shift);
+}
+
+HarmonicTable SampleAnalyser::toTable(const Magnitudes& sums)
+{
+    HarmonicTable table {};
+    if (sums[0] <= 0.0)
+        return table;
+
+    for (int i = 0; i < HarmonicSeries::numHarmonics; ++i)
+        table[(size_t) i] = (float) juce::jlimit(0.0, 1.0, sums[(size_t) i + 1] / sums[0]);
+
+    return table;
+}
+
+bool SampleAnalyser::analyseBuffer(const juce::AudioBuffer<float>& buffer, double sampleRate, const Options& options, Result& result)
+{
+    const int numSamples = buffer.getNumSamples();
+    juce::AudioBuffer<float> mono(1, numSamples);
+    mono.clear();
+    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+        mono.addFrom(0, 0, buffer, channel, 0, numSamples, 1.0f / (float) buffer.getNumChannels());
+
+    const int pitchSamples = juce::jmin(numSamples, (int) (options.pitchSeconds * sampleRate));
+    result = {};
+    result.fundamental = estimateFundamental(mono.getReadPointer(0, (numSamples - pitchSamples) / 2), pitchSamples, sampleRate);
+    result.finished = true;
+    result.progress = 1.0f;
+
+    if (result.fundamental <= 0.0f)
+        return false;
+
+    juce::dsp::FFT fft(options.fftOrder);
+    juce::dsp::WindowingFunction<float> window((size_t) fft.getSize(), juce::dsp::WindowingFunction<float>::hann, false);
+    std::vector<float> scratch((size_t) (2 * fft.getSize()));
+
+    Magnitudes sums {};
+    result.numWindows = measureWindows(mono.getReadPointer(0), numSamples, sampleRate, result.fundamental, options, fft, window, scratch.data(), sums);
+    result.table = toTable(sums);
+    return result.numWindows > 0;
+}
+
+bool SampleAnalyser::analyseFile(juce::AudioFormatManager& formats, const juce::File& file, const Options& options, Result& result)
+{
+    result = {};
+    result.finished = true;
+    result.progress = 1.0f;
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(file));
+    if (reader == nullptr)
+        return false;
+
+    result.fundamental = findFundamental(*reader, options);
+    if (result.fundamental <= 0.0f)
+        return false;
+
+    // The same runs analyse() queues, one after another, so a long file never sits in memory whole
+    const int numWindows = getNumWindows(reader->lengthInSamples, options);
+    const int windowsPerTask = juce::jmax(1, options.windowsPerTask);
+
+    Magnitudes sums {};
+    for (int first = 0; first < numWindows; first += windowsPerTask)
+        result.numWindows += measureRun(*reader, result.fundamental, options, first, juce::jmin(numWindows, first + windowsPerTask), sums);
+
+    result.table = toTable(sums);
+    return result.numWindows > 0;
+}
+
+//==============================================================================
+int SampleAnalyser::getNumWindows(juce::int64 numSamples, const Options& options)
+{
+    const int size = 1 << options.fftOrder;
+    if (numSamples <= size)
+        return 1;
+
+    return 1 + (int) ((numSamples - size) / (size / 2));
+}
+
+void SampleAnalyser::readMono(juce::AudioFormatReader& reader, juce::int64 start, int numSamples, juce::AudioBuffer<float>& mono)
+{
+    const int numChannels = juce::jmax(1, (int) reader.numChannels);
+    juce::AudioBuffer<float> channels(numChannels, numSamples);
+    reader.read(&channels, 0, numSamples, start, true, true);
+
+    mono.setSize(1, numSamples, false, false, true);
+    mono.clear();
+    for (int channel = 0; channel < numChannels; ++channel)
+        mono.addFrom(0, 0, channels, channel, 0, numSamples, 1.0f / (float) numChannels);
+}
+
+float SampleAnalyser::findFundamental(juce::AudioFormatReader& reader, const Options& options)
+{
+    // The attack and the release are the least steady parts, so the pitch comes from the middle
+    const auto numSamples = (int) juce::jmin(reader.lengthInSamples, (juce::int64) (options.pitchSeconds * reader.sampleRate));
+    if (numSamples <= 0)
+        return 0.0f;
+
+    juce::AudioBuffer<float> mono;
+    readMono(reader, (reader.lengthInSamples - numSamples) / 2, numSamples, mono);
+    return estimateFundamental(mono.getReadPointer(0), numSamples, reader.sampleRate);
+}
+
+int SampleAnalyser::measureRun(juce::AudioFormatReader& reader, float fundamental, const Options& options, int firstWindow, int lastWindow, Magnitudes& sums)
+{
+    juce::dsp::FFT fft(options.fftOrder);
+    const int size = fft.getSize();
+    juce::dsp::WindowingFunction<float> window((size_t) size, juce::dsp::WindowingFunction<float>::hann, false);
+    std::vector<float> scratch((size_t) (2 * size));
+
+    // Neighbouring windows overlap by half, so a run reads its windows' span once
+    const juce::int64 start = (juce::int64) firstWindow * (size / 2);
+    const int numSamples = (int) juce::jmin(reader.lengthInSamples - start, (juce::int64) (lastWindow - firstWindow + 1) * (size / 2));
+    if (numSamples <= 0)
+        return 0;
+
+    juce::AudioBuffer<float> mono;
+    readMono(reader, start, numSamples, mono);
+    return measureWindows(mono.getReadPointer(0), numSamples, reader.sampleRate, fundamental, options, fft, window, scratch.data(), sums);
+}
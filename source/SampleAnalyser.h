@@ -0,0 +1,97 @@
+#pragma once
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_dsp/juce_dsp.h>
+#include "BackgroundTasks.h"
+#include "HarmonicTable.h"
+
+// Measures a harmonic table from a recording of a sustained note.
+//
+// The fundamental comes from running the PitchTracker over the middle of
+// the file and taking the median of its confident estimates. Then every
+// Hann window along the file (half overlapped) is transformed, and the
+// peak closest to each multiple of the fundamental is picked. Windows
+// below the gate are left out, the rest are averaged, and each harmonic
+// is expressed relative to the fundamental.
+//
+// analyse() splits a file into runs of windows and measures them on the
+// shared BackgroundTasks pool, passing the running average back as each run lands.
+// analyseFolder() turns every audio file of a folder into a preset.
+// Message thread only, apart from the static helpers.
+class SampleAnalyser
+{
+public:
+    // Summed peak magnitudes, [0] is the fundamental and [h - 1] the hth harmonic
+    using Magnitudes = std::array<double, HarmonicSeries::numHarmonics + 1>;
+
+    struct Options
+    {
+        int fftOrder = 14;           // 16384 samples, a few Hz per bin at 48 kHz
+        int windowsPerTask = 16;
+        float gateLevel = 0.001f;    // RMS under which a window is not counted
+        double pitchSeconds = 2.0;   // how much of the middle of the file the pitch comes from
+    };
+
+    struct Result
+    {
+        HarmonicTable table {};
+        float fundamental = 0.0f;    // 0 when no pitch was found
+        int numWindows = 0;          // windows averaged so far
+        float progress = 0.0f;
+        bool finished = false;
+    };
+
+    SampleAnalyser();
+    ~SampleAnalyser();
+
+    // Measures file in the background. onUpdate runs on the message thread
+    // after every run of windows, with finished set on the last call.
+    // Starting another analysis drops this one's remaining updates.
+    void analyse(const juce::File& file, std::function<void(const Result&)> onUpdate);
+    void cancel();
+
+    // Writes one .preset per audio file in folder into destination, with
+    // the measured table in harm1, harm2 and combo. onFinished runs on the
+    // message thread with the number of presets written.
+    void analyseFolder(const juce::File& folder, const juce::File& destination, std::function<void(int numWritten)> onFinished);
+    bool isAnalysingFolder() const { return tasks.isRunningBatch(); }
+
+    static bool isAudioFile(const juce::File& file);
+
+    // Median pitch of samples in Hz, or 0 when under a quarter of it is pitched
+    static float estimateFundamental(const float* samples, int numSamples, double sampleRate);
+
+    // Adds the harmonic peaks of every window that fits in samples to sums,
+    // returning how many windows were counted. scratch needs 2 * fft.getSize() floats
+    static int measureWindows(const float* samples, int numSamples, double sampleRate, float fundamental, const Options& options,
+                              const juce::dsp::FFT& fft, const juce::dsp::WindowingFunction<float>& window, float* scratch, Magnitudes& sums);
+
+    // Magnitude at the true peak around a local maximum bin, from it and its neighbours
+    static double interpolatePeak(const float* magnitudes, int bin);
+
+    // Each harmonic's share of the fundamental, clipped to [0, 1]
+    static HarmonicTable toTable(const Magnitudes& sums);
+
+    // The whole analysis on the calling thread
+    static bool analyseBuffer(const juce::AudioBuffer<float>& buffer, double sampleRate, const Options& options, Result& result);
+    static bool analyseFile(juce::AudioFormatManager& formats, const juce::File& file, const Options& options, Result& result);
+
+private:
+    struct Analysis;
+    struct Batch;
+
+    static int getNumWindows(juce::int64 numSamples, const Options& options);
+    static void readMono(juce::AudioFormatReader& reader, juce::int64 start, int numSamples, juce::AudioBuffer<float>& mono);
+    static float findFundamental(juce::AudioFormatReader& reader, const Options& options);
+
+    // Reads windows [firstWindow, lastWindow) and adds them to sums
+    static int measureRun(juce::AudioFormatReader& reader, float fundamental, const Options& options, int firstWindow, int lastWindow, Magnitudes& sums);
+
+    static void pitchTask(const std::shared_ptr<Analysis>& analysis, BackgroundTasks& tasks);
+    static void measureTask(const std::shared_ptr<Analysis>& analysis, int firstWindow, int lastWindow);
+
+    juce::AudioFormatManager formats;
+    BackgroundTasks tasks;
+    std::shared_ptr<Analysis> current;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleAnalyser)
+};
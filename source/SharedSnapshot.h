@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// An immutable value that one writer republishes and any number of threads
+// read without locks. read() is wait-free: it counts itself in, loads the
+// current pointer and counts itself out.
+//
+// publish() swaps in a new value and retires the old one. Retired values
+// are deleted as soon as publish() or collectGarbage() sees no reader in
+// flight. A reader that counted itself in after that check was made is
+// guaranteed to load the newer pointer, because both sides use
+// sequentially consistent operations.
+//
+// Single writer: publish() and collectGarbage() must not run concurrently.
+template <typename T>
+class SharedSnapshot
+{
+public:
+    explicit SharedSnapshot (std::unique_ptr<const T> initial = std::make_unique<const T>())
+        : current (initial.release())
+    {
+    }
+
+    ~SharedSnapshot() { delete current.load(); }
+
+    SharedSnapshot (const SharedSnapshot&) = delete;
+    SharedSnapshot& operator= (const SharedSnapshot&) = delete;
+
+    // Calls reader (const T&) on the current value and returns what it returns
+    template <typename Reader>
+    auto read (Reader&& reader) const
+    {
+        const ReaderCount count (readersInFlight);
+        return reader (*current.load());
+    }
+
+    void publish (std::unique_ptr<const T> value)
+    {
+        retired.emplace_back (current.exchange (value.release()));
+        collectGarbage();
+    }
+
+    void collectGarbage()
+    {
+        if (readersInFlight.load() == 0)
+            retired.clear();
+    }
+
+    size_t getNumRetired() const noexcept { return retired.size(); }
+
+private:
+    struct ReaderCount
+    {
+        explicit ReaderCount (std::atomic<int>& c) : count (c) { count.fetch_add (1); }
+        ~ReaderCount() { count.fetch_sub (1); }
+        std::atomic<int>& count;
+    };
+
+    std::atomic<const T*> current;
+    mutable std::atomic<int> readersInFlight { 0 };
+    std::vector<std::unique_ptr<const T>> retired;
+};
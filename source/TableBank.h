@@ -0,0 +1,139 @@
+#pragma once
+#include "HarmonicTable.h"
+#include "MorphEngine.h"
+#include <juce_core/juce_core.h>
+
+// A bank of up to 16 harmonic tables placed on a 2D morph plane.
+// Slots 0 and 1 are the classic harm1/harm2 pair.
+//
+// Linear mode cross-fades slot 0 -> slot 1 with the Morph parameter,
+// shaped by the MorphEngine curve.
+// Vector mode blends every active slot by inverse-distance weighting
+// from the (MorphX, MorphY) point on the XY pad.
+struct TableBank
+{
+    static constexpr int maxTables = 16;
+
+    enum class MorphMode
+    {
+        linear,
+        vector
+    };
+
+    struct State
+    {
+        std::array<HarmonicTable, maxTables> tables {};
+        std::array<float, maxTables> x {};
+        std::array<float, maxTables> y {};
+        uint32_t activeMask = 0x3;
+
+        State()
+        {
+            for (int i = 0; i < maxTables; ++i)
+                std::tie (x[(size_t) i], y[(size_t) i]) = defaultPosition (i);
+        }
+
+        bool isActive (int slot) const noexcept { return (activeMask & (1u << slot)) != 0; }
+    };
+
+    struct MorphParameters
+    {
+        MorphMode mode = MorphMode::linear;
+        MorphEngine::Curve curve = MorphEngine::Curve::linear;
+        float morph = 0.5f;
+        float x = 0.5f;
+        float y = 0.5f;
+
+        bool operator== (const MorphParameters&) const = default;
+    };
+
+    using Weights = std::array<float, maxTables>;
+
+    // Corners first, then a ring around the centre of the pad
+    static std::pair<float, float> defaultPosition (int slot)
+    {
+        if (slot < 4)
+            return { static_cast<float> (slot % 2), static_cast<float> (slot / 2) };
+
+        const auto angle = juce::MathConstants<float>::twoPi * static_cast<float> (slot - 4) / (maxTables - 4);
+        return { 0.5f + 0.3f * std::cos (angle), 0.5f + 0.3f * std::sin (angle) };
+    }
+
+    static void computeWeights (const State& state, const MorphParameters& params, Weights& weights) noexcept
+    {
+        weights.fill (0.0f);
+
+        if (params.mode == MorphMode::linear)
+        {
+            weights[0] = 1.0f - params.morph;
+            weights[1] = params.morph;
+            return;
+        }
+
+        // Branch-free so the 16 lanes vectorise; the epsilon makes a slot the
+        // pad sits exactly on dominate without a special case
+        float sum = 0.0f;
+        for (size_t i = 0; i < maxTables; ++i)
+        {
+            const float dx = state.x[i] - params.x;
+            const float dy = state.y[i] - params.y;
+            const float active = static_cast<float> ((state.activeMask >> i) & 1u);
+            weights[i] = active / (dx * dx + dy * dy + 1.0e-5f);
+            sum += weights[i];
+        }
+
+        juce::FloatVectorOperations::multiply (weights.data(), 1.0f / sum, maxTables);
+    }
+
+    static void blend (const State& state, const Weights& weights, HarmonicTable& result) noexcept
+    {
+        result.fill (0.0f);
+
+        for (size_t i = 0; i < maxTables; ++i)
+            if (weights[i] > 0.0f)
+                juce::FloatVectorOperations::addWithMultiply (result.data(), state.tables[i].data(), weights[i], HarmonicSeries::numHarmonics);
+    }
+};
+
+// Audio-thread side of the bank: keeps the blended table and only
+// recomputes it when the bank or the morph parameters actually change,
+// so audio-rate XY automation of an unchanged value costs a compare.
+// Linear morphs are a lookup into the MorphEngine cache.
+class TableMorpher
+{
+public:
+    const HarmonicTable& update (const TableBank::State& state, bool bankChanged, const TableBank::MorphParameters& params) noexcept
+    {
+        if (bankChanged || ! hasTable || params != lastParams)
+        {
+            if (params.mode == TableBank::MorphMode::linear)
+            {
+                morphEngine.setCurve (params.curve);
+                morphEngine.setSources (state.tables[0], state.tables[1]);
+                morphEngine.lookup (params.morph, table);
+            }
+            else
+            {
+                TableBank::computeWeights (state, params, weights);
+                TableBank::blend (state, weights, table);
+            }
+
+            lastParams = params;
+            hasTable = true;
+        }
+
+        return table;
+    }
+
+    // A table drawn directly onto combo wins until the morph moves again
+    void overrideTable (const HarmonicTable& newTable) noexcept { table = newTable; }
+
+    const HarmonicTable& getTable() const noexcept { return table; }
+
+private:
+    MorphEngine morphEngine;
+    TableBank::Weights weights {};
+    TableBank::MorphParameters lastParams;
+    HarmonicTable table {};
+    bool hasTable = false;
+};
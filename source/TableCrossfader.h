@@ -0,0 +1,89 @@
+#pragma once
+#include "HarmonicTable.h"
+#include <juce_core/juce_core.h>
+
+// Ramps harmonic strengths from one table to another over a set time.
+//
+// Audio thread only, no allocation. The target can keep moving during a
+// ramp (the morph may change while a new preset fades in), in which case
+// the ramp simply heads for the latest target.
+class TableCrossfader
+{
+public:
+    void prepare(double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate;
+        length = position = 0;
+        initialised = false;
+    }
+
+    void setTransitionTime(double seconds) noexcept
+    {
+        transitionSamples = juce::jmax(0, juce::roundToInt(seconds * sampleRate));
+    }
+
+    // Moves towards table. startTransition begins a fresh ramp from
+    // wherever the output currently is, otherwise a ramp in progress carries
+    // on and an idle crossfader jumps straight to table.
+    void setTarget(const HarmonicTable& table, bool startTransition) noexcept
+    {
+        if (startTransition && initialised && transitionSamples > 0)
+        {
+            getTableAt(0, from);
+            position = 0;
+            length = transitionSamples;
+        }
+        else if (! isTransitioning())
+        {
+            from = table;
+        }
+
+        to = table;
+        initialised = true;
+    }
+
+    bool isTransitioning() const noexcept { return length > 0; }
+
+    // Partials that can be non-zero anywhere in the current ramp
+    int getNumActivePartials() const noexcept
+    {
+        return isTransitioning() ? juce::jmax(::getNumActivePartials(from), ::getNumActivePartials(to))
+                                 : ::getNumActivePartials(to);
+    }
+
+    // The blended table sampleOffset samples into the current block
+    void getTableAt(int sampleOffset, HarmonicTable& result) const noexcept
+    {
+        if (! isTransitioning())
+        {
+            result = to;
+            return;
+        }
+
+        const float mix = juce::jmin(1.0f, (float) (position + sampleOffset) / (float) length);
+        for (size_t i = 0; i < result.size(); ++i)
+            result[i] = from[i] + (to[i] - from[i]) * mix;
+    }
+
+    void advance(int numSamples) noexcept
+    {
+        if (! isTransitioning())
+            return;
+
+        position += numSamples;
+        if (position >= length)
+        {
+            from = to;
+            length = position = 0;
+        }
+    }
+
+private:
+    HarmonicTable from {};
+    HarmonicTable to {};
+    double sampleRate = 44100.0;
+    int transitionSamples = 0;
+    int length = 0;
+    int position = 0;
+    bool initialised = false;
+};
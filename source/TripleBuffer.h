@@ -0,0 +1,40 @@
+#pragma once
+#include <array>
+#include <atomic>
+
+// Wait-free single-producer/single-consumer handoff of a trivially copyable
+// value. The producer (message thread) fills getWriteBuffer() and calls
+// publish(); the consumer (audio thread) calls acquire() once per block and
+// reads getReadBuffer(). Neither side ever blocks or allocates.
+template <typename T>
+class TripleBuffer
+{
+public:
+    T& getWriteBuffer() noexcept { return buffers[(size_t) writeIndex]; }
+
+    void publish() noexcept
+    {
+        writeIndex = middle.exchange (writeIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    // Returns true if something was published since the last call
+    bool acquire() noexcept
+    {
+        if ((middle.load (std::memory_order_relaxed) & freshBit) == 0)
+            return false;
+
+        readIndex = middle.exchange (readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const T& getReadBuffer() const noexcept { return buffers[(size_t) readIndex]; }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshBit = 4;
+
+    std::array<T, 3> buffers {};
+    std::atomic<int> middle { 1 };
+    int writeIndex = 0;
+    int readIndex = 2;
+};
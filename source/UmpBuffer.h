@@ -0,0 +1,106 @@
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+
+// A block's worth of MIDI 2.0 channel voice messages as Universal MIDI
+// Packets, each tagged with its sample position.
+//
+// Storage is a flat preallocated word array, two words per packet, kept in
+// time order (events at the same sample stay in the order they were added).
+// prepare() allocates, nothing else does.
+class UmpBuffer
+{
+public:
+    static constexpr int wordsPerPacket = 2;
+
+    // Attribute type for a note-on carrying its exact pitch as 7.9 fixed point
+    static constexpr juce::uint8 pitchAttribute = 3;
+
+    void prepare (int capacity)
+    {
+        words.assign ((size_t) (capacity * wordsPerPacket), 0);
+        times.assign ((size_t) capacity, 0);
+        numPackets = 0;
+    }
+
+    void clear() noexcept { numPackets = 0; }
+    bool isEmpty() const noexcept { return numPackets == 0; }
+    int getNumPackets() const noexcept { return numPackets; }
+
+    const juce::uint32* getPacket (int index) const noexcept { return words.data() + index * wordsPerPacket; }
+    int getTime (int index) const noexcept { return times[(size_t) index]; }
+
+    // Returns false when the buffer is full
+    bool add (const juce::uint32* packet, int time) noexcept
+    {
+        if ((size_t) numPackets == times.size())
+            return false;
+
+        // Nearly always appends, events arrive in time order
+        int index = numPackets++;
+        for (; index > 0 && times[(size_t) index - 1] > time; --index)
+        {
+            times[(size_t) index] = times[(size_t) index - 1];
+            std::copy_n (getPacket (index - 1), wordsPerPacket, words.data() + index * wordsPerPacket);
+        }
+
+        times[(size_t) index] = time;
+        std::copy_n (packet, wordsPerPacket, words.data() + index * wordsPerPacket);
+        return true;
+    }
+
+    bool add (const juce::universal_midi_packets::PacketX2& packet, int time) noexcept
+    {
+        return add (packet.data(), time);
+    }
+
+    // Adds the MIDI 1.0 equivalent of every packet to midi, which is how
+    // packets leave the plugin. Per-note pitch has no MIDI 1.0 form and is dropped.
+    void convertToMidi1 (juce::MidiBuffer& midi) const noexcept
+    {
+        for (int i = 0; i < numPackets; ++i)
+            addAsMidi1 (getPacket (i), getTime (i), midi);
+    }
+
+    static void addAsMidi1 (const juce::uint32* packet, int time, juce::MidiBuffer& midi) noexcept
+    {
+        using juce::universal_midi_packets::Conversion;
+
+        const auto header = packet[0];
+        if ((header >> 28) != 0x4)
+            return;
+
+        const auto status = (juce::uint8) ((header >> 20) & 0xf);
+        const auto channel = (juce::uint8) ((header >> 16) & 0xf);
+        const auto note = (juce::uint8) ((header >> 8) & 0x7f);
+        const juce::uint8 statusByte = (juce::uint8) ((status << 4) | channel);
+
+        switch (status)
+        {
+            case 0x9: // note-on, where a MIDI 1.0 velocity of 0 would mean note-off
+            {
+                const juce::uint8 bytes[] { statusByte, note, juce::jmax ((juce::uint8) 1, Conversion::scaleTo7 ((juce::uint16) (packet[1] >> 16))) };
+                midi.addEvent (bytes, 3, time);
+                break;
+            }
+            case 0x8:
+            {
+                const juce::uint8 bytes[] { statusByte, note, Conversion::scaleTo7 ((juce::uint16) (packet[1] >> 16)) };
+                midi.addEvent (bytes, 3, time);
+                break;
+            }
+            case 0xa:
+            {
+                const juce::uint8 bytes[] { statusByte, note, Conversion::scaleTo7 (packet[1]) };
+                midi.addEvent (bytes, 3, time);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+private:
+    std::vector<juce::uint32> words;
+    std::vector<int> times;
+    int numPackets = 0;
+};
@@ -0,0 +1,144 @@
+#pragma once
+#include "HarmonicVoiceMap.h"
+
+// Fixed-capacity indexed min-heap of sounding harmonic voices.
+// The top is always the voice to steal next under the current policy.
+// Nothing allocates: capacity is a compile-time constant and each voice
+// remembers its heap position so it can be removed in O(log n) on note-off.
+class VoicePriorityQueue
+{
+public:
+    static constexpr int capacity = 256;
+
+    enum class Policy
+    {
+        weakestHarmonic, // lowest strength goes first, oldest breaks ties
+        oldestNote       // every partial of the oldest base note goes first
+    };
+
+    struct Node
+    {
+        HarmonicVoiceMap::Voice* voice = nullptr;
+        int channel = 0;
+        int baseNote = 0;
+        int harmonic = 0;
+    };
+
+    int size() const noexcept { return numNodes; }
+    bool isEmpty() const noexcept { return numNodes == 0; }
+    bool isFull() const noexcept { return numNodes == capacity; }
+    const Node& top() const noexcept { jassert (numNodes > 0); return nodes[0]; }
+
+    void clear() noexcept
+    {
+        for (int i = 0; i < numNodes; ++i)
+            nodes[(size_t) i].voice->queueIndex = -1;
+
+        numNodes = 0;
+    }
+
+    void setPolicy (Policy newPolicy) noexcept
+    {
+        if (newPolicy == policy)
+            return;
+
+        policy = newPolicy;
+
+        for (int i = numNodes / 2 - 1; i >= 0; --i)
+            siftDown (i);
+    }
+
+    Policy getPolicy() const noexcept { return policy; }
+
+    // Should the top voice make way for a new one of this strength and age?
+    // A note never steals from itself under the oldest policy.
+    bool shouldStealFor (float strength, uint32_t age) const noexcept
+    {
+        if (policy == Policy::oldestNote)
+            return top().voice->age < age;
+
+        return top().voice->strength < strength;
+    }
+
+    void push (const Node& node) noexcept
+    {
+        jassert (! isFull() && node.voice->queueIndex < 0);
+        place (numNodes++, node);
+        siftUp (numNodes - 1);
+    }
+
+    void remove (HarmonicVoiceMap::Voice& voice) noexcept
+    {
+        const int index = voice.queueIndex;
+        if (index < 0)
+            return;
+
+        voice.queueIndex = -1;
+
+        if (index != --numNodes)
+        {
+            place (index, nodes[(size_t) numNodes]);
+            siftDown (index);
+            siftUp (index);
+        }
+    }
+
+private:
+    bool goesBefore (const Node& a, const Node& b) const noexcept
+    {
+        if (policy == Policy::weakestHarmonic && a.voice->strength != b.voice->strength)
+            return a.voice->strength < b.voice->strength;
+
+        return a.voice->age < b.voice->age;
+    }
+
+    void place (int index, const Node& node) noexcept
+    {
+        nodes[(size_t) index] = node;
+        node.voice->queueIndex = index;
+    }
+
+    void siftUp (int index) noexcept
+    {
+        const auto node = nodes[(size_t) index];
+
+        while (index > 0)
+        {
+            const int parent = (index - 1) / 2;
+            if (! goesBefore (node, nodes[(size_t) parent]))
+                break;
+
+            place (index, nodes[(size_t) parent]);
+            index = parent;
+        }
+
+        place (index, node);
+    }
+
+    void siftDown (int index) noexcept
+    {
+        const auto node = nodes[(size_t) index];
+
+        for (;;)
+        {
+            int child = 2 * index + 1;
+            if (child >= numNodes)
+                break;
+
+            if (child + 1 < numNodes && goesBefore (nodes[(size_t) child + 1], nodes[(size_t) child]))
+                ++child;
+
+            if (! goesBefore (nodes[(size_t) child], node))
+                break;
+
+            place (index, nodes[(size_t) child]);
+            index = child;
+        }
+
+        place (index, node);
+    }
+
+    std::array<Node, capacity> nodes;
+    int numNodes = 0;
+    Policy policy = Policy::weakestHarmonic;
+};
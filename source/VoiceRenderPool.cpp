@@ -0,0 +1,244 @@
+#include "VoiceRenderPool.h"
+
+// The worker threads every VoiceRenderPool in the process shares
+class VoiceRenderPool::Workers
+{
+public:
+    ~Workers()
+    {
+        const int count = numWorkers.load();
+
+        for (int i = 0; i < count; ++i)
+        {
+            workers[(size_t) i]->signalThreadShouldExit();
+            workers[(size_t) i]->wake.signal();
+        }
+
+        for (int i = 0; i < count; ++i)
+            workers[(size_t) i]->stopThread (1000);
+    }
+
+    // Workers are only ever added, so a batch in flight never loses one
+    void ensureWorkers (int count)
+    {
+        const juce::ScopedLock sl (startLock);
+        count = juce::jmin (count, maxThreads - 1);
+
+        for (int i = numWorkers.load(); i < count; ++i)
+        {
+            auto& worker = workers[(size_t) i];
+            worker = std::make_unique<Worker> (*this, i + 1);
+
+            // Without realtime scheduling (no permission on Linux, say) it still runs, just not as smoothly
+            if (! worker->startRealtimeThread (juce::Thread::RealtimeOptions {}))
+                worker->startThread (juce::Thread::Priority::high);
+
+            numWorkers.store (i + 1, std::memory_order_release);
+        }
+    }
+
+    void setWorkgroup (const juce::AudioWorkgroup& newWorkgroup)
+    {
+        {
+            const juce::SpinLock::ScopedLockType sl (workgroupLock);
+            workgroup = newWorkgroup;
+        }
+
+        maxParallelThreads.store (newWorkgroup ? (int) newWorkgroup.getMaxParallelThreadCount() : 0);
+        ++workgroupVersion;
+    }
+
+    // False when another batch has the workers, the caller then runs everything itself
+    bool tryRun (int numTasks, int numThreads, TaskFunction function, void* context)
+    {
+        int threads = juce::jmin (numThreads, numWorkers.load (std::memory_order_acquire) + 1);
+
+        if (const int maxParallel = maxParallelThreads.load (std::memory_order_relaxed); maxParallel > 0)
+            threads = juce::jmin (threads, maxParallel);
+
+        if (threads < 2 || busy.exchange (true, std::memory_order_acquire))
+            return false;
+
+        // The task fields are published by the store to work, and nobody reads
+        // them again until the next batch has been published
+        taskFunction = function;
+        taskContext = context;
+        fpStatus.store (juce::FloatVectorOperations::getFpStatusRegister(), std::memory_order_relaxed);
+        batchThreads.store (threads, std::memory_order_relaxed);
+        remaining.store (numTasks, std::memory_order_relaxed);
+        work.store (((juce::uint64) ++batchNumber << 32) | ((juce::uint64) numTasks << 16));
+
+        for (int i = 0; i < threads - 1; ++i)
+            if (workers[(size_t) i]->sleeping.load())
+                workers[(size_t) i]->wake.signal();
+
+        while (runNextTask (batchNumber, 0))
+        {
+        }
+
+        // The last tasks are already running on workers and finish soon.
+        // Should a worker be preempted, the wait gives its core back.
+        for (int spins = 0; remaining.load (std::memory_order_acquire) > 0; ++spins)
+            if (spins >= callerSpinLimit)
+                juce::Thread::yield();
+
+        busy.store (false, std::memory_order_release);
+        return true;
+    }
+
+private:
+    class Worker : public juce::Thread
+    {
+    public:
+        Worker (Workers& owner, int threadIndex)
+            : juce::Thread ("Voice render " + juce::String (threadIndex)), pool (owner), index (threadIndex)
+        {
+        }
+
+        void run() override
+        {
+            juce::WorkgroupToken token;
+            juce::uint32 joinedVersion = 0;
+            auto seen = batchOf (pool.work.load (std::memory_order_acquire));
+
+            while (! threadShouldExit())
+            {
+                auto batch = seen;
+                const auto spinUntil = juce::Time::getHighResolutionTicks() + spinTicks;
+
+                while ((batch = batchOf (pool.work.load (std::memory_order_acquire))) == seen)
+                {
+                    if (threadShouldExit())
+                        return;
+
+                    // Consecutive segments of a callback arrive within this, so
+                    // only the first batch of a callback has to wake anyone
+                    if (juce::Time::getHighResolutionTicks() < spinUntil)
+                    {
+                        juce::Thread::yield();
+                        continue;
+                    }
+
+                    sleeping.store (true);
+                    if (batchOf (pool.work.load()) == seen)
+                        wake.wait (100);
+                    sleeping.store (false);
+                }
+
+                seen = batch;
+
+                if (const auto version = pool.workgroupVersion.load(); version != joinedVersion)
+                {
+                    pool.joinWorkgroup (token);
+                    joinedVersion = version;
+                }
+
+                if (index >= pool.batchThreads.load (std::memory_order_relaxed))
+                    continue;
+
+                // Tasks must round the same way here as on the calling thread
+                const auto status = pool.fpStatus.load (std::memory_order_relaxed);
+                if (juce::FloatVectorOperations::getFpStatusRegister() != status)
+                    juce::FloatVectorOperations::setFpStatusRegister (status);
+
+                while (pool.runNextTask (seen, index))
+                {
+                }
+            }
+        }
+
+        Workers& pool;
+        const int index;
+        std::atomic<bool> sleeping { false };
+        juce::WaitableEvent wake;
+
+    private:
+        const juce::int64 spinTicks = juce::Time::getHighResolutionTicksPerSecond() / 10000; // 100 us
+    };
+
+    // One word describes a batch: number (32 bits) | numTasks (16) | next task (16)
+    static juce::uint32 batchOf (juce::uint64 word) noexcept { return (juce::uint32) (word >> 32); }
+
+    static constexpr int callerSpinLimit = 1000;
+
+    bool runNextTask (juce::uint32 batch, int thread)
+    {
+        auto word = work.load (std::memory_order_acquire);
+
+        for (;;)
+        {
+            const auto numTasks = (word >> 16) & 0xffff;
+            const auto next = word & 0xffff;
+
+            // A worker that wakes late may still hold an old batch number, and
+            // must not claim anything from a newer batch
+            if (batchOf (word) != batch || next >= numTasks)
+                return false;
+
+            if (work.compare_exchange_weak (word, word + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                break;
+        }
+
+        taskFunction (taskContext, (int) (word & 0xffff), thread);
+        remaining.fetch_sub (1, std::memory_order_release);
+        return true;
+    }
+
+    // Only on a worker thread, and only when the workgroup has changed
+    void joinWorkgroup (juce::WorkgroupToken& token)
+    {
+        juce::AudioWorkgroup current;
+        {
+            const juce::SpinLock::ScopedLockType sl (workgroupLock);
+            current = workgroup;
+        }
+
+        token.reset();
+        if (current)
+            current.join (token);
+    }
+
+    std::atomic<juce::uint64> work { 0 };
+    std::atomic<int> remaining { 0 };
+    std::atomic<int> batchThreads { 0 };
+    std::atomic<intptr_t> fpStatus { 0 };
+    std::atomic<bool> busy { false };
+    TaskFunction taskFunction = nullptr;
+    void* taskContext = nullptr;
+    juce::uint32 batchNumber = 0;
+
+    juce::CriticalSection startLock;
+    std::array<std::unique_ptr<Worker>, maxThreads - 1> workers;
+    std::atomic<int> numWorkers { 0 };
+
+    juce::SpinLock workgroupLock;
+    juce::AudioWorkgroup workgroup;
+    std::atomic<juce::uint32> workgroupVersion { 0 };
+    std::atomic<int> maxParallelThreads { 0 };
+};
+
+//==============================================================================
+VoiceRenderPool::VoiceRenderPool() = default;
+VoiceRenderPool::~VoiceRenderPool() = default;
+
+void VoiceRenderPool::setNumThreads (int newNumThreads)
+{
+    numThreads = juce::jlimit (1, maxThreads, newNumThreads);
+    workers->ensureWorkers (numThreads - 1);
+}
+
+void VoiceRenderPool::setAudioWorkgroup (const juce::AudioWorkgroup& workgroup)
+{
+    workers->setWorkgroup (workgroup);
+}
+
+void VoiceRenderPool::runTasks (int numTasks, TaskFunction function, void* context)
+{
+    jassert (numTasks <= 0xffff);
+
+    if (numTasks >= 2 && workers->tryRun (numTasks, numThreads, function, context))
+        return;
+
+    for (int i = 0; i < numTasks; ++i)
+        function (context, i, 0);
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+
+// Fork/join helper for splitting render work across threads inside the
+// audio callback.
+//
+// Every VoiceRenderPool in the process shares one set of realtime worker
+// threads, started the first time any of them asks for more than one
+// thread, so a session full of synths still has at most maxThreads - 1
+// render threads. A batch has the workers to itself: when another
+// instance's batch holds them, run() renders on the calling thread alone.
+//
+// run() publishes a batch with a single atomic store, and the workers and
+// the calling thread each claim tasks from it with compare-and-swap until
+// none are left. No locks are taken on the audio thread. Workers spin for
+// a short, fixed time after each batch to catch the next one of the same
+// callback, then sleep on an event, which run() signals. They join the
+// host's audio workgroup when there is one, and take on the calling
+// thread's denormal mode before running its tasks.
+//
+// Tasks must write to separate outputs. Callers that want the same result
+// whatever the thread count should mix those outputs in task order.
+class VoiceRenderPool
+{
+public:
+    static constexpr int maxThreads = 8;
+
+    VoiceRenderPool();
+    ~VoiceRenderPool();
+
+    // Sets how many threads take part in run(), including the caller.
+    // May start workers, so this must not be called from the audio thread.
+    void setNumThreads (int numThreads);
+    int getNumThreads() const noexcept { return numThreads; }
+
+    // The workgroup of the host's audio threads, which the workers join
+    // before their next batch. Also caps how many threads a batch uses.
+    void setAudioWorkgroup (const juce::AudioWorkgroup& workgroup);
+
+    // Calls task (index, thread) once for every index in [0, numTasks) and
+    // returns when all of them have finished. thread is in
+    // [0, getNumThreads()) and is 0 for the calling thread.
+    template <typename Task>
+    void run (int numTasks, Task& task)
+    {
+        runTasks (numTasks, [] (void* context, int index, int thread) { (*static_cast<Task*> (context)) (index, thread); }, &task);
+    }
+
+private:
+    using TaskFunction = void (*) (void* context, int index, int thread);
+    class Workers;
+
+    void runTasks (int numTasks, TaskFunction function, void* context);
+
+    juce::SharedResourcePointer<Workers> workers;
+    int numThreads = 1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (VoiceRenderPool)
+};
@@ -0,0 +1,182 @@
+#include "WavetableExporter.h"
+
+// One file being exported. The tables are loaded and the frames allocated
+// once its first run starts, so a big library export only holds a few
+// sweeps at a time.
+struct WavetableExporter::Output
+{
+    Job job;
+    std::once_flag started;
+    bool loaded = false;
+    juce::HeapBlock<float> frames;
+    std::atomic<int> framesLeft { 0 };
+};
+
+// One item per file
+struct WavetableExporter::Batch : BackgroundTasks::Batch
+{
+    Options options;
+    std::vector<std::unique_ptr<Output>> outputs;
+};
+
+WavetableExporter::WavetableExporter() = default;
+
+WavetableExporter::~WavetableExporter()
+{
+    tasks.stop();
+}
+
+void WavetableExporter::exportTables(std::vector<Job> jobs, const Options& options, std::function<void(int numWritten)> onFinished)
+{
+    jassert(juce::isPowerOfTwo(options.frameSize));
+
+    auto batch = tasks.startBatch<Batch>((int) jobs.size(), std::move(onFinished));
+    batch->options = options;
+
+    for (auto& job : jobs)
+    {
+        auto output = std::make_unique<Output>();
+        output->job = std::move(job);
+        output->job.numFrames = juce::jmax(1, output->job.numFrames);
+        output->framesLeft = output->job.numFrames;
+        batch->outputs.push_back(std::move(output));
+    }
+
+    // Queued file by file, so the pool works through the files roughly in order
+    const int framesPerTask = juce::jmax(1, options.framesPerTask);
+    for (auto& output : batch->outputs)
+    {
+        for (int first = 0; first < output->job.numFrames; first += framesPerTask)
+        {
+            const int last = juce::jmin(output->job.numFrames, first + framesPerTask);
+            tasks.addJob([batch, output = output.get(), first, last]() { renderTask(batch, *output, first, last); });
+        }
+    }
+}
+
+void WavetableExporter::renderTask(const std::shared_ptr<Batch>& batch, Output& output, int firstFrame, int lastFrame)
+{
+    const auto& options = batch->options;
+    const int frameSize = options.frameSize;
+
+    std::call_once(output.started, [&output, frameSize]() {
+        output.loaded = output.job.load == nullptr || output.job.load(output.job);
+        if (output.loaded)
+            output.frames.calloc((size_t) output.job.numFrames * (size_t) frameSize);
+    });
+
+    if (output.loaded)
+        renderFrames(output.job, options, firstFrame, lastFrame, output.frames + (size_t) firstFrame * (size_t) frameSize);
+
+    if (output.framesLeft.fetch_sub(lastFrame - firstFrame) != lastFrame - firstFrame)
+        return;
+
+    if (! output.loaded)
+    {
+        batch->itemDone(false);
+        return;
+    }
+
+    // Last run of this file: the whole sweep shares one gain, so the frames stay in proportion
+    const int numSamples = output.job.numFrames * frameSize;
+    normalise(output.frames, numSamples);
+
+    const bool written = writeWav(output.job.file, output.frames, output.job.numFrames, frameSize, options.sampleRate);
+    output.frames.free();
+
+    batch->itemDone(written);
+}
+
+//==============================================================================
+void WavetableExporter::renderFrame(const HarmonicTable& table, bool includeFundamental, const juce::dsp::FFT& fft, float* spectrum, float* frame)
+{
+    const int size = fft.getSize();
+    std::fill(spectrum, spectrum + 2 * size, 0.0f);
+
+    // A sine of amplitude a in bin k is -j * a * size / 2, as the inverse divides by size
+    auto setBin = [spectrum, size](int bin, float amplitude) {
+        if (bin < size / 2)
+        {
+            spectrum[2 * bin + 1] = -amplitude * 0.5f * (float) size;
+            spectrum[2 * (size - bin) + 1] = amplitude * 0.5f * (float) size;
+        }
+    };
+
+    if (includeFundamental)
+        setBin(1, 1.0f);
+
+    // Harmonic i is the (i + 2)th
+    for (int i = 0; i < HarmonicSeries::numHarmonics; ++i)
+        setBin(i + 2, table[(size_t) i]);
+
+    fft.performRealOnlyInverseTransform(spectrum);
+    std::copy(spectrum, spectrum + size, frame);
+}
+
+void WavetableExporter::renderFrames(const Job& job, const Options& options, int firstFrame, int lastFrame, float* frames)
+{
+    juce::dsp::FFT fft(juce::roundToInt(std::log2(options.frameSize)));
+    std::vector<float> spectrum((size_t) (2 * options.frameSize));
+
+    MorphEngine morph;
+    morph.setCurve(job.curve);
+    morph.setSources(job.from, job.to);
+
+    HarmonicTable table {};
+    for (int frame = firstFrame; frame < lastFrame; ++frame)
+    {
+        const float position = job.numFrames > 1 ? (float) frame / (float) (job.numFrames - 1) : 0.0f;
+        morph.lookup(position, table);
+        renderFrame(table, options.includeFundamental, fft, spectrum.data(), frames + (size_t) (frame - firstFrame) * (size_t) options.frameSize);
+    }
+}
+
+void WavetableExporter::normalise(float* frames, int numSamples)
+{
+    const auto range = juce::FloatVectorOperations::findMinAndMax(frames, numSamples);
+    const float peak = juce::jmax(std::abs(range.getStart()), std::abs(range.getEnd()));
+
+    if (peak > 0.0f)
+        juce::FloatVectorOperations::multiply(frames, 1.0f / peak, numSamples);
+}
+
+bool WavetableExporter::writeWav(juce::OutputStream& out, const float* frames, int numFrames, int frameSize, double sampleRate)
+{
+    // Frame size marker read by wavetable synths, padded to an even length
+    juce::String marker = "<!>" + juce::String(frameSize) + " 00000000 wavetable (Additive Midi)";
+    if (marker.length() % 2 != 0)
+        marker << " ";
+
+    const auto dataSize = (juce::uint32) ((size_t) numFrames * (size_t) frameSize * sizeof(float));
+    const auto markerSize = (juce::uint32) marker.length();
+    const auto sampleRateHz = (juce::uint32) juce::roundToInt(sampleRate);
+
+    bool ok = out.write("RIFF", 4)
+           && out.writeInt((int) (4 + (8 + 16) + (8 + markerSize) + (8 + dataSize)))
+           && out.write("WAVE", 4);
+
+    // Mono 32-bit IEEE float
+    ok = ok && out.write("fmt ", 4) && out.writeInt(16)
+            && out.writeShort(3) && out.writeShort(1)
+            && out.writeInt((int) sampleRateHz) && out.writeInt((int) (sampleRateHz * sizeof(float)))
+            && out.writeShort((short) sizeof(float)) && out.writeShort(32);
+
+    ok = ok && out.write("clm ", 4) && out.writeInt((int) markerSize)
+            && out.write(marker.toRawUTF8(), markerSize);
+
+    ok = ok && out.write("data", 4) && out.writeInt((int) dataSize);
+
+    for (size_t i = 0; ok && i < (size_t) numFrames * (size_t) frameSize; ++i)
+        ok = out.writeFloat(frames[i]);
+
+    return ok;
+}
+
+bool WavetableExporter::writeWav(const juce::File& file, const float* frames, int numFrames, int frameSize, double sampleRate)
+{
+    juce::MemoryOutputStream out((size_t) numFrames * (size_t) frameSize * sizeof(float) + 256);
+    if (! writeWav(out, frames, numFrames, frameSize, sampleRate))
+        return false;
+
+    return file.getParentDirectory().createDirectory().wasOk() && file.replaceWithData(out.getData(), out.getDataSize());
+}
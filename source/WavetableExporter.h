@@ -0,0 +1,71 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include "BackgroundTasks.h"
+#include "MorphEngine.h"
+
+// Turns harmonic tables into single-cycle wavetables for other synths.
+//
+// Each frame is one cycle, built by an inverse FFT from a spectrum holding
+// the fundamental and one bin per harmonic. A sweep is numFrames frames
+// along the harm1 -> harm2 morph, following the same MorphEngine curve the
+// plugin uses. The file is a 32-bit float WAV with a "clm " chunk giving
+// the frame size, which is the layout wavetable synths look for.
+//
+// exportTables() splits every sweep into runs of frames and renders them
+// on the shared BackgroundTasks pool. The task that finishes a file's last run
+// normalises it and writes it. Message thread only, apart from the static
+// helpers.
+class WavetableExporter
+{
+public:
+    struct Job
+    {
+        juce::File file;
+        HarmonicTable from {};
+        HarmonicTable to {};
+        int numFrames = 1;
+        MorphEngine::Curve curve = MorphEngine::Curve::linear;
+
+        // Fills in from and to on a worker before the first frame, so a job
+        // can read its tables from disk there. A job that fails isn't written
+        std::function<bool(Job& job)> load;
+    };
+
+    struct Options
+    {
+        int frameSize = 2048; // a power of two
+        double sampleRate = 44100.0;
+        bool includeFundamental = true;
+        int framesPerTask = 32;
+    };
+
+    WavetableExporter();
+    ~WavetableExporter();
+
+    // Writes every job's file in the background. onFinished runs on the
+    // message thread with the number of files written.
+    void exportTables(std::vector<Job> jobs, const Options& options, std::function<void(int numWritten)> onFinished);
+    bool isExporting() const { return tasks.isRunningBatch(); }
+
+    // One cycle of table into frame[0, fft.getSize()). spectrum needs 2 * fft.getSize() floats
+    static void renderFrame(const HarmonicTable& table, bool includeFundamental, const juce::dsp::FFT& fft, float* spectrum, float* frame);
+
+    // Frames [firstFrame, lastFrame) of job's sweep into frames, frameSize floats each
+    static void renderFrames(const Job& job, const Options& options, int firstFrame, int lastFrame, float* frames);
+
+    // Scales the whole wavetable so its peak is at full scale
+    static void normalise(float* frames, int numSamples);
+
+    static bool writeWav(juce::OutputStream& out, const float* frames, int numFrames, int frameSize, double sampleRate);
+    static bool writeWav(const juce::File& file, const float* frames, int numFrames, int frameSize, double sampleRate);
+
+private:
+    struct Batch;
+    struct Output;
+
+    static void renderTask(const std::shared_ptr<Batch>& batch, Output& output, int firstFrame, int lastFrame);
+
+    BackgroundTasks tasks;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WavetableExporter)
+};
@@ -0,0 +1,81 @@
+#include "XYPad.h"
+
+XYPad::XYPad(juce::RangedAudioParameter& xParameter, juce::RangedAudioParameter& yParameter)
+    : xAttachment(xParameter, [this](float value) {
+          xValue = value;
+          repaint();
+          if (onValueChange != nullptr)
+              onValueChange();
+      }),
+      yAttachment(yParameter, [this](float value) {
+          yValue = value;
+          repaint();
+          if (onValueChange != nullptr)
+              onValueChange();
+      })
+{
+    setOpaque(true);
+    xAttachment.sendInitialUpdate();
+    yAttachment.sendInitialUpdate();
+}
+
+void XYPad::setBankState(const TableBank::State& state)
+{
+    bank = state;
+    repaint();
+}
+
+juce::Point<float> XYPad::toPosition(float x, float y) const
+{
+    // y grows upwards on the pad
+    return { x * static_cast<float>(getWidth()), (1.0f - y) * static_cast<float>(getHeight()) };
+}
+
+void XYPad::paint(juce::Graphics& g)
+{
+    g.fillAll(juce::Colour(0xff191919));
+
+    g.setColour(juce::Colours::grey);
+    g.drawRect(getLocalBounds());
+
+    // Bank slots
+    for (int slot = 0; slot < TableBank::maxTables; ++slot)
+    {
+        if (! bank.isActive(slot))
+            continue;
+
+        const auto centre = toPosition(bank.x[(size_t) slot], bank.y[(size_t) slot]);
+        g.setColour(slot == 0 ? juce::Colour(0xffc7884d) : slot == 1 ? juce::Colour(0xff89b4c1) : juce::Colours::lightgrey);
+        g.fillEllipse(centre.x - 4.0f, centre.y - 4.0f, 8.0f, 8.0f);
+    }
+
+    // Morph position
+    const auto puck = toPosition(xValue, yValue);
+    g.setColour(juce::Colour(0xffE0E0E0));
+    g.drawEllipse({ puck.x - 7.0f, puck.y - 7.0f, 14.0f, 14.0f }, 2.0f);
+}
+
+void XYPad::mouseDown(const juce::MouseEvent& e)
+{
+    if (onDragStart != nullptr)
+        onDragStart();
+    xAttachment.beginGesture();
+    yAttachment.beginGesture();
+    mouseDrag(e);
+}
+
+void XYPad::mouseDrag(const juce::MouseEvent& e)
+{
+    const float x = juce::jlimit(0.0f, 1.0f, e.position.x / static_cast<float>(juce::jmax(1, getWidth())));
+    const float y = juce::jlimit(0.0f, 1.0f, 1.0f - e.position.y / static_cast<float>(juce::jmax(1, getHeight())));
+    xAttachment.setValueAsPartOfGesture(x);
+    yAttachment.setValueAsPartOfGesture(y);
+}
+
+void XYPad::mouseUp(const juce::MouseEvent&)
+{
+    xAttachment.endGesture();
+    yAttachment.endGesture();
+    if (onDragEnd != nullptr)
+        onDragEnd();
+}
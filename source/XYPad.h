@@ -0,0 +1,40 @@
+#pragma once
+#include "TableBank.h"
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+// Two-parameter pad for the vector morph. Shows where the bank slots sit
+// and drags the MorphX / MorphY parameters as one gesture.
+class XYPad : public juce::Component
+{
+public:
+    XYPad(juce::RangedAudioParameter& xParameter, juce::RangedAudioParameter& yParameter);
+    ~XYPad() override {}
+
+    void paint(juce::Graphics& g) override;
+
+    void setBankState(const TableBank::State& state);
+
+    float getXValue() const { return xValue; }
+    float getYValue() const { return yValue; }
+
+    std::function<void()> onValueChange;
+    std::function<void()> onDragStart;
+    std::function<void()> onDragEnd;
+
+private:
+    void mouseDown(const juce::MouseEvent& e) override;
+    void mouseDrag(const juce::MouseEvent& e) override;
+    void mouseUp(const juce::MouseEvent& e) override;
+
+    juce::Point<float> toPosition(float x, float y) const;
+
+    float xValue = 0.5f;
+    float yValue = 0.5f;
+    TableBank::State bank;
+
+    juce::ParameterAttachment xAttachment;
+    juce::ParameterAttachment yAttachment;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (XYPad)
+};
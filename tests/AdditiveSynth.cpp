@@ -0,0 +1,152 @@
+#include <AdditiveSynth.h>
+#include <catch2/catch_test_macros.hpp>
+
+static TableCrossfader constantTable (const HarmonicTable& table)
+{
+    TableCrossfader tables;
+    tables.prepare (48000.0);
+    tables.setTarget (table, false);
+    return tables;
+}
+
+TEST_CASE ("Additive synth", "[synth]")
+{
+    AdditiveSynth synth;
+    synth.prepare (48000.0, 512);
+    synth.setEnvelope (0.001f, 0.01f);
+
+    SECTION ("the polynomial sine tracks std::sin")
+    {
+        float worst = 0.0f;
+        for (int i = 0; i < 4096; ++i)
+        {
+            const float phase = (float) i / 4096.0f;
+            worst = juce::jmax (worst, std::abs (AdditiveSynth::sine (phase) - std::sin (juce::MathConstants<float>::twoPi * phase)));
+        }
+        REQUIRE (worst < 1.0e-4f);
+    }
+
+    SECTION ("a note sounds its partials and frees them after release")
+    {
+        HarmonicTable table {};
+        table[0] = 0.5f;
+        auto tables = constantTable (table);
+
+        juce::AudioBuffer<float> audio (2, 512);
+        audio.clear();
+        juce::MidiBuffer midi;
+        midi.addEvent (juce::MidiMessage::noteOn (1, 60, 1.0f), 100);
+        synth.render (audio, midi, tables);
+
+        REQUIRE (synth.getNumActiveVoices() == 1);
+        REQUIRE (synth.getNumActivePartials() == AdditiveSynth::partialsPerVoice);
+        REQUIRE (audio.getMagnitude (0, 0, 100) == 0.0f);
+        REQUIRE (audio.getMagnitude (0, 100, 412) > 0.0f);
+        REQUIRE (audio.getSample (1, 300) == audio.getSample (0, 300));
+
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::noteOff (1, 60), 0);
+        for (int block = 0; block < 4; ++block)
+        {
+            audio.clear();
+            synth.render (audio, midi, tables);
+            midi.clear();
+        }
+
+        REQUIRE (synth.getNumActiveVoices() == 0);
+        audio.clear();
+        synth.render (audio, midi, tables);
+        REQUIRE (audio.getMagnitude (0, 0, 512) == 0.0f);
+    }
+
+    SECTION ("voices stay packed when one in the middle ends")
+    {
+        auto tables = constantTable ({});
+        juce::AudioBuffer<float> audio (1, 512);
+        juce::MidiBuffer midi;
+        for (int note = 60; note < 63; ++note)
+            midi.addEvent (juce::MidiMessage::noteOn (1, note, 1.0f), 0);
+        synth.render (audio, midi, tables);
+
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::noteOff (1, 61), 0);
+        for (int block = 0; block < 2; ++block)
+        {
+            synth.render (audio, midi, tables);
+            midi.clear();
+        }
+
+        REQUIRE (synth.getNumActiveVoices() == 2);
+    }
+
+    SECTION ("the output is the same on any number of threads")
+    {
+        HarmonicTable table;
+        table.fill (0.25f);
+        auto tables = constantTable (table);
+
+        juce::MidiBuffer midi;
+        for (int v = 0; v < 64; ++v)
+            midi.addEvent (juce::MidiMessage::noteOn (1, 30 + v, 0.8f), v);
+
+        auto renderWith = [&] (int numThreads) {
+            AdditiveSynth threaded;
+            threaded.prepare (48000.0, 512);
+            threaded.setNumThreads (numThreads);
+
+            juce::AudioBuffer<float> audio (1, 2048);
+            audio.clear();
+            threaded.render (audio, midi, tables);
+            return audio;
+        };
+
+        const auto single = renderWith (1);
+        const auto multi = renderWith (4);
+        REQUIRE (single.getMagnitude (0, 0, 2048) > 0.0f);
+        REQUIRE (std::equal (single.getReadPointer (0), single.getReadPointer (0) + 2048, multi.getReadPointer (0)));
+    }
+}
+
+TEST_CASE ("Voice render pool", "[synth]")
+{
+    VoiceRenderPool pool;
+    pool.setNumThreads (4);
+    REQUIRE (pool.getNumThreads() == 4);
+
+    // Every task runs exactly once per batch, on a valid thread, over many batches
+    std::array<std::atomic<int>, 100> runs {};
+    std::atomic<bool> badThread { false };
+    auto task = [&] (int index, int thread) {
+        runs[(size_t) index].fetch_add (1);
+        if (thread < 0 || thread >= 4)
+            badThread = true;
+    };
+
+    for (int batch = 0; batch < 1000; ++batch)
+        pool.run ((int) runs.size(), task);
+
+    REQUIRE (! badThread);
+    REQUIRE (std::all_of (runs.begin(), runs.end(), [] (auto& count) { return count.load() == 1000; }));
+}
+
+TEST_CASE ("Voice render pools share their workers", "[synth]")
+{
+    // Two instances rendering at once: whichever finds the workers busy renders alone
+    std::array<VoiceRenderPool, 2> pools;
+    std::array<std::array<std::atomic<int>, 64>, 2> runs {};
+
+    auto renderOn = [&] (size_t which) {
+        pools[which].setNumThreads (4);
+        auto task = [&] (int index, int) { runs[which][(size_t) index].fetch_add (1); };
+
+        for (int batch = 0; batch < 500; ++batch)
+            pools[which].run ((int) runs[which].size(), task);
+    };
+
+    std::thread other ([&] { renderOn (1); });
+    renderOn (0);
+    other.join();
+
+    for (auto& counts : runs)
+        REQUIRE (std::all_of (counts.begin(), counts.end(), [] (auto& count) { return count.load() == 500; }));
+}
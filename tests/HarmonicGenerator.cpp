@@ -0,0 +1,737 @@
+#include <EditHistory.h>
+#include <HarmonicGenerator.h>
+#include <MorphEngine.h>
+#include <TableBank.h>
+#include <catch2/catch_test_macros.hpp>
+
+static int countEvents (const juce::MidiBuffer& midi, const std::function<bool (const juce::MidiMessage&)>& predicate)
+{
+    int count = 0;
+    for (const auto metadata : midi)
+        if (predicate (metadata.getMessage()))
+            ++count;
+    return count;
+}
+
+TEST_CASE ("Harmonic fan-out", "[generator]")
+{
+    HarmonicGenerator generator;
+    generator.prepare (512);
+
+    HarmonicTable table {};
+    table[0] = 1.0f;
+    table[2] = 0.5f;
+
+    juce::MidiBuffer midi;
+    midi.addEvent (juce::MidiMessage::noteOn (1, 48, (juce::uint8) 100), 0);
+    generator.process (midi, table);
+
+    SECTION ("note-on generates the non-zero harmonics")
+    {
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOn(); }) == 3);
+    }
+
+    SECTION ("poly aftertouch reaches every live harmonic, scaled by strength")
+    {
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::aftertouchChange (1, 48, 100), 10);
+        generator.process (midi, table);
+
+        CHECK (countEvents (midi, [] (auto& m) { return m.isAftertouch(); }) == 3);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isAftertouch() && m.getNoteNumber() == 72 && m.getAfterTouchValue() == 50; }) == 1);
+    }
+
+    SECTION ("note-off releases the harmonics the note-on started, even after a table change")
+    {
+        table.fill (1.0f);
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::noteOff (1, 48), 20);
+        generator.process (midi, table);
+
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOff(); }) == 3);
+    }
+
+    SECTION ("controller streams pass untouched unless decimation is on")
+    {
+        midi.clear();
+        for (int i = 0; i < 8; ++i)
+            midi.addEvent (juce::MidiMessage::controllerEvent (1, 1, i), i);
+        generator.process (midi, table);
+
+        CHECK (countEvents (midi, [] (auto& m) { return m.isController() && m.getControllerNumber() == 1; }) == 8);
+    }
+
+    SECTION ("controller streams are decimated to their last value per block")
+    {
+        generator.setDecimateControllers (true);
+        midi.clear();
+        for (int i = 0; i < 64; ++i)
+        {
+            midi.addEvent (juce::MidiMessage::aftertouchChange (1, 48, i), i);
+            midi.addEvent (juce::MidiMessage::controllerEvent (1, 1, i), i);
+        }
+        midi.addEvent (juce::MidiMessage::controllerEvent (1, 64, 127), 1);
+        midi.addEvent (juce::MidiMessage::controllerEvent (1, 64, 0), 2);
+        generator.process (midi, table);
+
+        CHECK (countEvents (midi, [] (auto& m) { return m.isAftertouch(); }) == 3);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isController() && m.getControllerNumber() == 1; }) == 1);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isController() && m.getControllerNumber() == 64; }) == 2);
+    }
+}
+
+TEST_CASE ("Pass-through blocks", "[generator]")
+{
+    HarmonicGenerator generator;
+    generator.prepare (512);
+
+    HarmonicTable table {};
+    table.fill (1.0f);
+
+    juce::MidiBuffer midi;
+    midi.addEvent (juce::MidiMessage::midiClock(), 0);
+    midi.addEvent (juce::MidiMessage::controllerEvent (1, 1, 10), 4);
+    midi.addEvent (juce::MidiMessage::controllerEvent (1, 7, 100), 8);
+    const auto* storage = (*midi.cbegin()).data;
+
+    SECTION ("a block without notes keeps its own storage")
+    {
+        generator.process (midi, table);
+        CHECK (midi.getNumEvents() == 3);
+        CHECK ((*midi.cbegin()).data == storage);
+    }
+
+    SECTION ("a controller stream that gets thinned out still goes through the generator")
+    {
+        generator.setDecimateControllers (true);
+        midi.addEvent (juce::MidiMessage::controllerEvent (1, 1, 20), 12);
+        generator.process (midi, table);
+        CHECK (midi.getNumEvents() == 3);
+    }
+
+    SECTION ("a note-off still releases the harmonics of a held note")
+    {
+        juce::MidiBuffer noteOn;
+        noteOn.addEvent (juce::MidiMessage::noteOn (1, 48, (juce::uint8) 100), 0);
+        generator.process (noteOn, table);
+
+        midi.addEvent (juce::MidiMessage::noteOff (1, 48), 16);
+        generator.process (midi, table);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOff(); }) == 1 + HarmonicSeries::numHarmonics);
+    }
+}
+
+TEST_CASE ("Harmonic voice budget", "[generator]")
+{
+    HarmonicGenerator generator;
+    generator.prepare (512);
+    generator.setLimits (4, 4096);
+
+    HarmonicTable table {};
+    table.fill (0.5f);
+    table[0] = 1.0f;
+
+    juce::MidiBuffer midi;
+    midi.addEvent (juce::MidiMessage::noteOn (1, 36, (juce::uint8) 100), 0);
+    generator.process (midi, table);
+
+    CHECK (generator.getNumActiveVoices() == 4);
+
+    SECTION ("weakest harmonics are stolen for stronger ones")
+    {
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::noteOn (1, 40, (juce::uint8) 100), 0);
+        generator.process (midi, table);
+
+        CHECK (generator.getNumActiveVoices() == 4);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOff(); }) == 1);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOn() && m.getNoteNumber() == 52; }) == 1);
+    }
+
+    SECTION ("oldest voices are stolen first under the oldest policy")
+    {
+        generator.setStealPolicy (VoicePriorityQueue::Policy::oldestNote);
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::noteOn (1, 40, (juce::uint8) 100), 0);
+        generator.process (midi, table);
+
+        // All four partials of note 36 make way, then note 40 takes their place
+        CHECK (generator.getNumActiveVoices() == 4);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOff(); }) == 4);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOff() && m.getNoteNumber() == 48; }) == 1);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOn() && m.getNoteNumber() == 68; }) == 1);
+
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::noteOff (1, 36), 0);
+        generator.process (midi, table);
+
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOff(); }) == 1);
+        CHECK (generator.getNumActiveVoices() == 4);
+    }
+
+    SECTION ("a note does not steal its own partials under the oldest policy")
+    {
+        generator.setStealPolicy (VoicePriorityQueue::Policy::oldestNote);
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::noteOff (1, 36), 0);
+        midi.addEvent (juce::MidiMessage::noteOn (1, 40, (juce::uint8) 100), 1);
+        generator.process (midi, table);
+
+        CHECK (generator.getNumActiveVoices() == 4);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOff() && m.getNoteNumber() > 40; }) == 4);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOn() && m.getNoteNumber() > 40; }) == 4);
+    }
+
+    SECTION ("generated events stop at the per-block budget, note-offs still pass")
+    {
+        generator.setLimits (VoicePriorityQueue::capacity, 16);
+        midi.clear();
+        for (int note = 50; note < 60; ++note)
+            midi.addEvent (juce::MidiMessage::noteOn (1, note, (juce::uint8) 100), 0);
+        generator.process (midi, table);
+
+        // The budget is spent after two note-ons and 14 harmonics,
+        // the remaining 8 incoming note-ons still pass
+        CHECK (midi.getNumEvents() == 16 + 8);
+        CHECK (generator.getNumActiveVoices() == 4 + 14);
+
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::noteOff (1, 36), 0);
+        generator.process (midi, table);
+
+        CHECK (generator.getNumActiveVoices() == 14);
+    }
+}
+
+TEST_CASE ("Table bank morph", "[morph]")
+{
+    TableBank::State bank;
+    bank.tables[0].fill (0.0f);
+    bank.tables[1].fill (1.0f);
+
+    TableBank::Weights weights;
+    HarmonicTable result;
+
+    SECTION ("linear mode cross-fades harm1 to harm2")
+    {
+        TableBank::computeWeights (bank, { TableBank::MorphMode::linear, MorphEngine::Curve::linear, 0.25f, 0.5f, 0.5f }, weights);
+        TableBank::blend (bank, weights, result);
+        CHECK (result[3] == 0.25f);
+    }
+
+    SECTION ("vector mode lands on the slot under the pad")
+    {
+        bank.tables[3].fill (0.5f);
+        bank.activeMask |= 1u << 3;
+        TableBank::computeWeights (bank, { TableBank::MorphMode::vector, MorphEngine::Curve::linear, 0.0f, 1.0f, 1.0f }, weights);
+        TableBank::blend (bank, weights, result);
+        CHECK (std::abs (result[0] - 0.5f) < 1.0e-3f);
+    }
+}
+
+TEST_CASE ("Morph engine", "[morph]")
+{
+    MorphEngine engine;
+    HarmonicTable from {}, to {}, result {};
+    to.fill (1.0f);
+    engine.setSources (from, to);
+
+    SECTION ("linear curve matches a plain cross-fade")
+    {
+        engine.lookup (0.3f, result);
+        CHECK (std::abs (result[5] - 0.3f) < 1.0e-5f);
+    }
+
+    SECTION ("equal power keeps strength up in the middle")
+    {
+        engine.setCurve (MorphEngine::Curve::equalPower);
+        engine.lookup (0.5f, result);
+        CHECK (std::abs (result[0] - std::sqrt (0.5f)) < 1.0e-3f);
+    }
+
+    SECTION ("staggered curve fades the top partial last")
+    {
+        engine.setCurve (MorphEngine::Curve::staggered);
+        engine.lookup (0.25f, result);
+        CHECK (result[0] == 0.5f);
+        CHECK (result[7] == 0.0f);
+    }
+
+    SECTION ("a single edited partial only rebuilds its own column")
+    {
+        to[2] = 0.5f;
+        engine.setSources (from, to);
+        CHECK (engine.getNumColumnsLastUpdated() == 1);
+
+        engine.lookup (1.0f, result);
+        CHECK (result[2] == 0.5f);
+    }
+}
+
+TEST_CASE ("Edit history", "[history]")
+{
+    EditHistory history;
+    std::array<float, 8> table {};
+    auto apply = [&] (int target, int index, float value) {
+        if (target == 0)
+            table[(size_t) index] = value;
+    };
+
+    SECTION ("a drag undoes as one step and coalesces repeated bars")
+    {
+        history.beginGesture();
+        history.record (0, 2, 0.0f, 0.3f);
+        history.record (0, 2, 0.3f, 0.6f);
+        history.record (0, 3, 0.0f, 0.5f);
+        history.endGesture();
+        table[2] = 0.6f;
+        table[3] = 0.5f;
+
+        REQUIRE (history.getNumDeltas() == 2);
+        REQUIRE (history.undo (apply));
+        REQUIRE (table[2] == 0.0f);
+        REQUIRE (table[3] == 0.0f);
+        REQUIRE_FALSE (history.canUndo());
+
+        REQUIRE (history.redo (apply));
+        REQUIRE (table[2] == 0.6f);
+        REQUIRE (table[3] == 0.5f);
+    }
+
+    SECTION ("a new edit drops the redo branch")
+    {
+        history.record (0, 0, 0.0f, 1.0f);
+        history.undo (apply);
+        history.record (0, 1, 0.0f, 1.0f);
+        REQUIRE_FALSE (history.canRedo());
+        REQUIRE (history.getNumDeltas() == 1);
+    }
+
+    SECTION ("memory stays bounded over a long session")
+    {
+        for (int i = 0; i < EditHistory::capacity * 3; ++i)
+            history.record (EditHistory::morphTarget, 0, (float) i, (float) i + 1.0f);
+
+        REQUIRE (history.getNumDeltas() == EditHistory::capacity);
+        REQUIRE (history.canUndo());
+    }
+}
+
+TEST_CASE ("Channel routing", "[generator]")
+{
+    HarmonicGenerator generator;
+    generator.prepare (512);
+
+    // Octave and fifth to channel 2, the next octave stays on the input channel
+    HarmonicGenerator::Routing routing {};
+    routing[0] = 2;
+    routing[1] = 2;
+    generator.setRouting (routing);
+
+    HarmonicTable table {};
+    table[0] = table[1] = table[2] = 1.0f;
+
+    juce::MidiBuffer midi;
+    midi.addEvent (juce::MidiMessage::noteOn (3, 48, (juce::uint8) 100), 0);
+    generator.process (midi, table);
+
+    SECTION ("each partial starts on its routed channel")
+    {
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOn() && m.getChannel() == 2; }) == 2);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOn() && m.getChannel() == 3; }) == 2);
+    }
+
+    SECTION ("note-offs and pressure follow the channel a harmonic started on")
+    {
+        // Changing the routing mid-note must not strand what is already sounding
+        generator.setRouting ({});
+
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::aftertouchChange (3, 48, 64), 0);
+        midi.addEvent (juce::MidiMessage::noteOff (3, 48), 10);
+        generator.process (midi, table);
+
+        CHECK (countEvents (midi, [] (auto& m) { return m.isAftertouch() && m.getChannel() == 2; }) == 2);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOff() && m.getChannel() == 2; }) == 2);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOff() && m.getChannel() == 3; }) == 2);
+    }
+
+    SECTION ("sustain and pitch bend reach the routed channel too")
+    {
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::controllerEvent (3, 64, 127), 0);
+        midi.addEvent (juce::MidiMessage::pitchWheel (3, 12000), 5);
+        midi.addEvent (juce::MidiMessage::controllerEvent (1, 64, 127), 6);
+        generator.process (midi, table);
+
+        CHECK (countEvents (midi, [] (auto& m) { return m.isController() && m.getChannel() == 3; }) == 1);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isPitchWheel() && m.getChannel() == 2 && m.getPitchWheelValue() == 12000; }) == 1);
+
+        // Channel 1 hasn't played anything, so its pedal stays where it is
+        CHECK (countEvents (midi, [] (auto& m) { return m.isController() && m.getChannel() == 1; }) == 1);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isController() && m.getChannel() == 2; }) == 1);
+    }
+
+    SECTION ("program changes, channel mode messages and other channels stay put")
+    {
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::programChange (3, 5), 0);
+        midi.addEvent (juce::MidiMessage::controllerEvent (3, 0, 1), 1);
+        midi.addEvent (juce::MidiMessage::controllerEvent (3, 121, 0), 2);
+        midi.addEvent (juce::MidiMessage::programChange (1, 7), 3);
+        midi.addEvent (juce::MidiMessage::allNotesOff (1), 4);
+        generator.process (midi, table);
+
+        CHECK (countEvents (midi, [] (auto& m) { return m.getChannel() == 2; }) == 0);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isProgramChange(); }) == 2);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isAllNotesOff() && m.getChannel() == 1; }) == 1);
+    }
+
+    SECTION ("channel-wide messages stay put without routing")
+    {
+        generator.setRouting ({});
+
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::controllerEvent (3, 64, 127), 0);
+        generator.process (midi, table);
+
+        CHECK (midi.getNumEvents() == 1);
+    }
+}
+
+TEST_CASE ("Table crossfade", "[generator]")
+{
+    TableCrossfader crossfader;
+    crossfader.prepare (1000.0);
+    crossfader.setTransitionTime (0.1); // 100 samples
+
+    HarmonicTable before {};
+    before[0] = 1.0f;
+    HarmonicTable after {};
+    after[1] = 1.0f;
+
+    crossfader.setTarget (before, false);
+    crossfader.setTarget (after, true);
+    REQUIRE (crossfader.isTransitioning());
+
+    HarmonicTable table {};
+    crossfader.getTableAt (50, table);
+    CHECK (table[0] == 0.5f);
+    CHECK (table[1] == 0.5f);
+
+    SECTION ("note-ons pick up the ramp at their sample position")
+    {
+        HarmonicGenerator generator;
+        generator.prepare (512);
+
+        juce::MidiBuffer midi;
+        midi.addEvent (juce::MidiMessage::noteOn (1, 48, (juce::uint8) 100), 50);
+        generator.process (midi, crossfader);
+
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOn() && m.getNoteNumber() == 60 && m.getVelocity() == 50; }) == 1);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOn() && m.getNoteNumber() == 67 && m.getVelocity() == 50; }) == 1);
+
+        // Released after the ramp, the note still lets go of both harmonics it started
+        crossfader.advance (200);
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::noteOff (1, 48), 0);
+        generator.process (midi, crossfader);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOff(); }) == 3);
+    }
+
+    SECTION ("the ramp ends on the target and stays there")
+    {
+        crossfader.advance (100);
+        REQUIRE_FALSE (crossfader.isTransitioning());
+        crossfader.getTableAt (0, table);
+        CHECK (table == after);
+    }
+}
+
+TEST_CASE ("Lookahead strum", "[generator]")
+{
+    HarmonicGenerator generator;
+    generator.prepare (64, 100);
+    generator.setLookahead (100, -80.0f, 0.0f); // harmonic i lands (i + 1) * 10 samples early
+
+    HarmonicTable table {};
+    table[0] = 1.0f;
+    table[1] = 1.0f;
+
+    juce::MidiBuffer midi;
+    midi.addEvent (juce::MidiMessage::noteOn (1, 48, (juce::uint8) 100), 0);
+    generator.process (midi, table, 64);
+    REQUIRE (midi.isEmpty());
+
+    // Samples 64 to 127: harmonic 1 at 80, harmonic 0 at 90, the base note on time at 100
+    midi.clear();
+    generator.process (midi, table, 64);
+
+    std::vector<std::pair<int, int>> notes;
+    for (const auto metadata : midi)
+        notes.emplace_back (metadata.getMessage().getNoteNumber(), metadata.samplePosition);
+
+    REQUIRE (notes.size() == 3);
+    CHECK (notes[0] == std::make_pair (67, 16));
+    CHECK (notes[1] == std::make_pair (60, 26));
+    CHECK (notes[2] == std::make_pair (48, 36));
+
+    SECTION ("note-offs keep each harmonic's offset")
+    {
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::noteOff (1, 48), 0);
+        generator.process (midi, table, 64);
+        midi.clear();
+        generator.process (midi, table, 64);
+
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOff() && m.getNoteNumber() == 67; }) == 1);
+        for (const auto metadata : midi)
+            if (metadata.getMessage().getNoteNumber() == 67)
+                CHECK (metadata.samplePosition == 16);
+    }
+
+    SECTION ("switching lookahead off flushes what is still pending")
+    {
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::noteOff (1, 48), 0);
+        generator.process (midi, table, 64);
+        generator.setLookahead (0, 0.0f, 0.0f);
+        midi.clear();
+        generator.process (midi, table, 64);
+
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOff(); }) == 3);
+    }
+
+    SECTION ("sysex waits the latency like the notes around it")
+    {
+        const juce::uint8 sysex[] { 0xf0, 0x7d, 0x01, 0x02, 0x03, 0xf7 };
+
+        midi.clear();
+        midi.addEvent (sysex, (int) sizeof (sysex), 10);
+        generator.process (midi, table, 64);
+        CHECK (midi.isEmpty());
+
+        midi.clear();
+        generator.process (midi, table, 64);
+        REQUIRE (midi.getNumEvents() == 1);
+
+        const auto metadata = *midi.begin();
+        CHECK (metadata.samplePosition == 46);
+        CHECK (metadata.numBytes == (int) sizeof (sysex));
+        CHECK (std::equal (sysex, sysex + sizeof (sysex), metadata.data));
+    }
+}
+
+TEST_CASE ("Delayed sysex", "[generator]")
+{
+    MidiDelayLine delayLine;
+    delayLine.prepare (100, 64, 16, 8);
+
+    const juce::uint8 first[] { 0xf0, 0x01, 0x02, 0xf7 };
+    const juce::uint8 second[] { 0xf0, 0x03, 0xf7 };
+    const juce::uint8 third[] { 0xf0, 0x04, 0x05, 0x06, 0xf7 };
+
+    REQUIRE (delayLine.add (first, 4, 10, 0));
+    REQUIRE (delayLine.add (second, 3, 20, 0));
+
+    SECTION ("a message that doesn't fit the ring goes out straight away")
+    {
+        CHECK_FALSE (delayLine.add (third, 5, 30, 0));
+    }
+
+    SECTION ("one that wraps around the ring comes back whole")
+    {
+        juce::MidiBuffer out;
+        delayLine.read (0, 16, out);
+        REQUIRE (out.getNumEvents() == 1);
+        CHECK (std::equal (first, first + 4, (*out.begin()).data));
+
+        REQUIRE (delayLine.add (third, 5, 30, 16));
+        out.clear();
+        delayLine.read (16, 32, out);
+        REQUIRE (out.getNumEvents() == 2);
+
+        auto it = out.begin();
+        CHECK ((*it).numBytes == 3);
+        ++it;
+        CHECK ((*it).samplePosition == 14);
+        CHECK (std::equal (third, third + 5, (*it).data));
+    }
+}
+
+TEST_CASE ("Lookahead retrigger", "[generator]")
+{
+    HarmonicGenerator generator;
+    generator.prepare (64, 100);
+    generator.setLookahead (100, 80.0f, 0.0f); // harmonic i lands (i + 1) * 10 samples late
+
+    HarmonicTable table {};
+    table[0] = 1.0f;
+    table[1] = 1.0f;
+
+    juce::MidiBuffer midi;
+    midi.addEvent (juce::MidiMessage::noteOn (1, 48, (juce::uint8) 100), 0);
+    generator.process (midi, table, 64);
+
+    // Retriggered with the strum reversed, each new note-on would be due
+    // 20 and 40 samples before the release of the note it replaces
+    generator.setLookahead (100, -80.0f, 0.0f);
+    midi.clear();
+    midi.addEvent (juce::MidiMessage::noteOn (1, 48, (juce::uint8) 100), 0);
+
+    std::vector<juce::MidiMessage> events;
+    for (int block = 0; block < 6; ++block)
+    {
+        generator.process (midi, table, 64);
+        for (const auto metadata : midi)
+            events.push_back (metadata.getMessage());
+        midi.clear();
+    }
+
+    for (const int note : { 60, 67 })
+    {
+        INFO ("harmonic note " << note);
+        std::vector<bool> isOn;
+        for (const auto& event : events)
+            if (event.getNoteNumber() == note && (event.isNoteOn() || event.isNoteOff()))
+                isOn.push_back (event.isNoteOn());
+
+        // The first note, its release, then the retriggered note left sounding
+        CHECK (isOn == std::vector<bool> { true, false, true });
+    }
+}
+
+TEST_CASE ("MIDI 2.0 output", "[generator]")
+{
+    using namespace juce::universal_midi_packets;
+
+    HarmonicGenerator generator;
+    generator.prepare (512);
+
+    UmpBuffer packets;
+    packets.prepare (64);
+    generator.setUmpOutput (&packets);
+
+    HarmonicTable table {};
+    table[0] = 0.5f;
+    table[1] = 0.001f; // far below one MIDI 1.0 velocity step
+
+    juce::MidiBuffer midi;
+    midi.addEvent (juce::MidiMessage::noteOn (1, 48, (juce::uint8) 100), 7);
+    generator.process (midi, table);
+
+    SECTION ("harmonics become packets, the base note stays MIDI 1.0")
+    {
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOn(); }) == 1);
+        REQUIRE (packets.getNumPackets() == 2);
+
+        const auto* octave = packets.getPacket (0);
+        CHECK (packets.getTime (0) == 7);
+        CHECK ((octave[0] >> 20 & 0xf) == 0x9);
+        CHECK ((octave[0] >> 8 & 0x7f) == 60);
+        CHECK ((octave[1] >> 16) == (juce::uint32) juce::roundToInt (Conversion::scaleTo16 ((juce::uint8) 100) * 0.5f));
+        CHECK ((octave[0] & 0xff) == UmpBuffer::pitchAttribute);
+        CHECK ((octave[1] & 0xffff) == 60u * 512u);
+    }
+
+    SECTION ("weak partials keep their resolution and carry their true pitch")
+    {
+        const auto* fifth = packets.getPacket (1);
+        const auto velocity = fifth[1] >> 16;
+        CHECK (velocity > 1);
+        CHECK (velocity < 512); // would have been clamped to 1 in MIDI 1.0
+
+        // 3rd harmonic of C3 is 19.02 semitones up, not 19
+        const auto pitch = (float) (fifth[1] & 0xffff) / 512.0f;
+        CHECK (std::abs (pitch - (48.0f + 12.0f * std::log2 (3.0f))) < 0.002f);
+    }
+
+    SECTION ("converting for MIDI 1.0 hosts keeps every note sounding")
+    {
+        juce::MidiBuffer converted;
+        packets.convertToMidi1 (converted);
+
+        std::vector<int> velocities;
+        for (const auto metadata : converted)
+            velocities.push_back (metadata.getMessage().getVelocity());
+
+        REQUIRE (velocities.size() == 2);
+        CHECK (velocities[0] == 50);
+        CHECK (velocities[1] == 1);
+    }
+
+    SECTION ("note-offs follow as packets")
+    {
+        packets.clear();
+        midi.clear();
+        midi.addEvent (juce::MidiMessage::noteOff (1, 48), 0);
+        generator.process (midi, table);
+
+        REQUIRE (packets.getNumPackets() == 2);
+        CHECK ((packets.getPacket (0)[0] >> 20 & 0xf) == 0x8);
+        CHECK (countEvents (midi, [] (auto& m) { return m.isNoteOff(); }) == 1);
+    }
+}
+
+TEST_CASE ("Specialised kernels", "[generator]")
+{
+    // A busy stream touching every event path, with a table using 3 of the 8 partials
+    HarmonicTable table {};
+    table[0] = 1.0f;
+    table[2] = 0.25f;
+
+    juce::Random random (7);
+    std::vector<juce::MidiBuffer> blocks (16);
+    for (auto& block : blocks)
+    {
+        for (int i = 0; i < 48; ++i)
+        {
+            const int note = 36 + random.nextInt (24);
+            const int time = random.nextInt (64);
+            switch (random.nextInt (4))
+            {
+                case 0:  block.addEvent (juce::MidiMessage::noteOn (1, note, (juce::uint8) (1 + random.nextInt (127))), time); break;
+                case 1:  block.addEvent (juce::MidiMessage::noteOff (1, note), time); break;
+                case 2:  block.addEvent (juce::MidiMessage::aftertouchChange (1, note, random.nextInt (128)), time); break;
+                default: block.addEvent (juce::MidiMessage::controllerEvent (1, 1, random.nextInt (128)), time); break;
+            }
+        }
+    }
+
+    auto run = [&] (bool generic, bool decimate, int lookahead, bool ump) {
+        HarmonicGenerator generator;
+        generator.prepare (64, 32);
+        generator.setUseGenericKernel (generic);
+        generator.setDecimateControllers (decimate);
+        generator.setLookahead (lookahead, 16.0f, 0.0f);
+
+        UmpBuffer packets;
+        packets.prepare (4096);
+        generator.setUmpOutput (ump ? &packets : nullptr);
+
+        std::vector<juce::uint8> bytes;
+        for (const auto& block : blocks)
+        {
+            auto midi = block;
+            packets.clear();
+            generator.process (midi, table, 64);
+
+            for (const auto metadata : midi)
+            {
+                bytes.push_back ((juce::uint8) metadata.samplePosition);
+                bytes.insert (bytes.end(), metadata.data, metadata.data + metadata.numBytes);
+            }
+
+            for (int i = 0; i < packets.getNumPackets(); ++i)
+                for (int w = 0; w < UmpBuffer::wordsPerPacket; ++w)
+                    for (int shift = 0; shift < 32; shift += 8)
+                        bytes.push_back ((juce::uint8) (packets.getPacket (i)[w] >> shift));
+        }
+        return bytes;
+    };
+
+    for (const bool decimate : { false, true })
+        for (const int lookahead : { 0, 32 })
+            for (const bool ump : { false, true })
+                CHECK (run (true, decimate, lookahead, ump) == run (false, decimate, lookahead, ump));
+}
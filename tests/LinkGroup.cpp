@@ -0,0 +1,185 @@
+#include <LinkGroup.h>
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE ("Link group", "[link]")
+{
+    struct Member : LinkGroup::Listener
+    {
+        void linkedTablesChanged (bool bankChanged, bool comboChanged) override
+        {
+            last = group->read ([] (const PublishedTables& tables) { return tables; });
+            ++numChanges;
+            lastBankChanged = bankChanged;
+            lastComboChanged = comboChanged;
+        }
+
+        std::shared_ptr<LinkGroup> group;
+        PublishedTables last;
+        int numChanges = 0;
+        bool lastBankChanged = false;
+        bool lastComboChanged = false;
+    };
+
+    Member first, second, other;
+    PublishedTables initial;
+    initial.bank.tables[0][0] = 0.5f;
+
+    auto group = LinkGroup::join ("Strings", first, initial, {});
+    auto sameGroup = LinkGroup::join ("Strings", second, {}, {});
+    first.group = second.group = group;
+
+    SECTION ("members of one name share one group")
+    {
+        auto otherGroup = LinkGroup::join ("Brass", other, {}, {});
+
+        CHECK (group == sameGroup);
+        CHECK (group->getNumMembers() == 2);
+        CHECK (otherGroup != group);
+        CHECK (otherGroup->getId() != group->getId());
+
+        otherGroup->leave (other);
+    }
+
+    SECTION ("the first member's tables start the group")
+    {
+        CHECK (group->read ([] (const PublishedTables& tables) { return tables.bank.tables[0][0]; }) == 0.5f);
+    }
+
+    SECTION ("a publish reaches every member but the one that made it")
+    {
+        HarmonicTable combo {};
+        combo[1] = 0.25f;
+        group->publish (initial.bank, combo, false, true, false, &first);
+
+        // Nobody hears about it until their own message thread gets to it
+        CHECK (second.numChanges == 0);
+        first.handleLinkedChangesNow();
+        second.handleLinkedChangesNow();
+
+        CHECK (first.numChanges == 0);
+        CHECK (second.numChanges == 1);
+        CHECK (second.lastComboChanged);
+        CHECK_FALSE (second.lastBankChanged);
+        CHECK (second.last.combo[1] == 0.25f);
+
+        // Only what changed gets a new version, which is what audio threads compare
+        CHECK (second.last.comboVersion == 1);
+        CHECK (second.last.bankVersion == 0);
+        CHECK (group->read ([] (const PublishedTables& tables) { return tables.comboVersion; }) == 1);
+    }
+
+    SECTION ("publishes pending for a member arrive as one change")
+    {
+        group->publish (initial.bank, {}, true, false, false, &first);
+        group->publish (initial.bank, {}, false, true, false, &first);
+        second.handleLinkedChangesNow();
+
+        CHECK (second.numChanges == 1);
+        CHECK (second.lastBankChanged);
+        CHECK (second.lastComboChanged);
+        CHECK (second.last.bankVersion == 1);
+        CHECK (second.last.comboVersion == 1);
+    }
+
+    SECTION ("a member that leaves hears nothing more")
+    {
+        group->publish (initial.bank, {}, true, false, false, &first);
+        group->leave (second);
+        second.handleLinkedChangesNow();
+
+        CHECK (second.numChanges == 0);
+        sameGroup = LinkGroup::join ("Strings", second, {}, {});
+    }
+
+    SECTION ("members can publish from their own threads at once")
+    {
+        // Each member's message thread publishing its own edits
+        constexpr int publishesEach = 500;
+        std::vector<std::thread> threads;
+
+        for (auto* member : { &first, &second })
+        {
+            threads.emplace_back ([&, member] {
+                for (int i = 0; i < publishesEach; ++i)
+                {
+                    group->publish (initial.bank, {}, true, false, false, member);
+                    group->collectGarbage();
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        first.handleLinkedChangesNow();
+        second.handleLinkedChangesNow();
+
+        CHECK (group->read ([] (const PublishedTables& tables) { return tables.bankVersion; }) == 2 * publishesEach);
+        CHECK (first.numChanges == 1);
+        CHECK (second.numChanges == 1);
+        CHECK (first.last.bankVersion == 2 * publishesEach);
+        CHECK (second.last.bankVersion == 2 * publishesEach);
+    }
+
+    SECTION ("the morph is whatever was written last")
+    {
+        TableBank::MorphParameters morph;
+        morph.mode = TableBank::MorphMode::vector;
+        morph.morph = 0.9f;
+        morph.x = 0.1f;
+
+        sameGroup->setMorph (morph);
+        CHECK (group->getMorph() == morph);
+    }
+
+    SECTION ("the group goes with its last member")
+    {
+        const auto id = group->getId();
+        group->leave (first);
+        group->leave (second);
+        group.reset();
+        sameGroup.reset();
+
+        PublishedTables fresh;
+        fresh.bank.tables[0][0] = 0.75f;
+        auto rejoined = LinkGroup::join ("Strings", first, fresh, {});
+
+        CHECK (rejoined->getId() != id);
+        CHECK (rejoined->getNumMembers() == 1);
+        CHECK (rejoined->read ([] (const PublishedTables& tables) { return tables.bank.tables[0][0]; }) == 0.75f);
+
+        rejoined->leave (first);
+    }
+
+    SECTION ("members can join and leave from any thread")
+    {
+        // A host restoring sessions on its own threads while the editor publishes
+        std::array<Member, 4> joiners;
+        std::vector<std::thread> threads;
+
+        for (auto& joiner : joiners)
+        {
+            threads.emplace_back ([&joiner] {
+                for (int i = 0; i < 200; ++i)
+                    LinkGroup::join ("Strings", joiner, {}, {})->leave (joiner);
+            });
+        }
+
+        for (int i = 0; i < 200; ++i)
+            group->publish (initial.bank, {}, true, false, false, &first);
+
+        for (auto& thread : threads)
+            thread.join();
+
+        CHECK (group->getNumMembers() == 2);
+        CHECK (LinkGroup::join ("Strings", other, {}, {}) == group);
+        group->leave (other);
+    }
+
+    // Members leave before they go, as the processor does in its destructor
+    if (group != nullptr)
+    {
+        group->leave (first);
+        group->leave (second);
+    }
+}
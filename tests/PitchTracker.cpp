@@ -0,0 +1,49 @@
+#include <PitchTracker.h>
+#include <catch2/catch_test_macros.hpp>
+
+static std::vector<float> sine (double sampleRate, float frequency, float amplitude, int numSamples)
+{
+    std::vector<float> samples ((size_t) numSamples);
+    for (int i = 0; i < numSamples; ++i)
+        samples[(size_t) i] = amplitude * std::sin (juce::MathConstants<float>::twoPi * frequency * (float) i / (float) sampleRate);
+    return samples;
+}
+
+TEST_CASE ("Pitch tracker", "[pitch]")
+{
+    constexpr double sampleRate = 48000.0;
+    PitchTracker tracker;
+    tracker.prepare (sampleRate, 512);
+
+    // A3, long enough for a full window plus the two confirming hops
+    auto audio = sine (sampleRate, 220.0f, 0.5f, tracker.getWindowSize() + 3 * tracker.getHopSize());
+    const float* channels[] = { audio.data() };
+
+    juce::MidiBuffer midi;
+    tracker.process (channels, 1, (int) audio.size(), midi);
+
+    SECTION ("a steady tone becomes one base note")
+    {
+        REQUIRE (tracker.getLastEstimate().frequency > 218.0f);
+        REQUIRE (tracker.getLastEstimate().frequency < 222.0f);
+        REQUIRE (tracker.getCurrentNote() == 57);
+
+        int noteOns = 0;
+        for (const auto metadata : midi)
+            if (metadata.getMessage().isNoteOn() && metadata.getMessage().getNoteNumber() == 57)
+                ++noteOns;
+        REQUIRE (noteOns == 1);
+    }
+
+    SECTION ("silence releases it")
+    {
+        std::vector<float> silence ((size_t) (3 * tracker.getHopSize()), 0.0f);
+        const float* silent[] = { silence.data() };
+
+        midi.clear();
+        tracker.process (silent, 1, (int) silence.size(), midi);
+
+        REQUIRE (tracker.getCurrentNote() == -1);
+        REQUIRE (midi.getNumEvents() == 1);
+    }
+}
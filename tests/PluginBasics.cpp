@@ -19,6 +19,149 @@ TEST_CASE ("Plugin instance", "[instance]")
     }
 }
 
+TEST_CASE ("Partial parameters", "[instance]")
+{
+    PluginProcessor testPlugin;
+    auto& apvts = testPlugin.getAPVTS();
+
+    SECTION ("host automation of a partial reaches the tables")
+    {
+        auto* fifth = apvts.getParameter ("Harm1_H3");
+        REQUIRE (fifth != nullptr);
+
+        // With no editor open, the processor picks it up on its own
+        fifth->setValueNotifyingHost (0.75f);
+        testPlugin.handlePendingChangesNow();
+        CHECK (testPlugin.getHarm1Data()[1] == 0.75f);
+        CHECK (testPlugin.takeOutsideChanges());
+        CHECK_FALSE (testPlugin.takeOutsideChanges());
+    }
+
+    SECTION ("automation is saved and restored from the parameters")
+    {
+        apvts.getParameter ("Harm2_H4")->setValueNotifyingHost (0.5f);
+        juce::MemoryBlock state;
+        testPlugin.getStateInformation (state);
+
+        PluginProcessor restored;
+        restored.setStateInformation (state.getData(), (int) state.getSize());
+        CHECK (restored.getHarm2Data()[2] == 0.5f);
+        CHECK (restored.getAPVTS().getParameter ("Harm2_H4")->getValue() == 0.5f);
+    }
+
+    SECTION ("combo's partials are read-only outputs")
+    {
+        auto* comboPartial = apvts.getParameter ("Combo_H2");
+        CHECK_FALSE (comboPartial->isAutomatable());
+
+        comboPartial->setValueNotifyingHost (1.0f);
+        testPlugin.handlePendingChangesNow();
+        CHECK_FALSE (testPlugin.takeOutsideChanges());
+    }
+
+    SECTION ("editing a table moves its parameters")
+    {
+        testPlugin.setBankTable (1, { 0.5f, 0.0f, 0.25f });
+        CHECK (apvts.getParameter ("Harm2_H2")->getValue() == 0.5f);
+        CHECK (apvts.getParameter ("Harm2_H4")->getValue() == 0.25f);
+
+        // Our own edits are already in the tables
+        testPlugin.handlePendingChangesNow();
+        CHECK_FALSE (testPlugin.takeOutsideChanges());
+    }
+}
+
+TEST_CASE ("Saved state", "[instance]")
+{
+    PluginProcessor testPlugin;
+
+    juce::MemoryBlock first, second;
+    testPlugin.getStateInformation (first);
+    testPlugin.getStateInformation (second);
+
+    SECTION ("an unchanged instance saves the same blob again")
+    {
+        CHECK (first == second);
+    }
+
+    SECTION ("table edits and parameter moves both show up in the next save")
+    {
+        testPlugin.setBankTable (0, { 1.0f, 0.5f });
+        juce::MemoryBlock afterEdit;
+        testPlugin.getStateInformation (afterEdit);
+        CHECK (afterEdit != first);
+
+        testPlugin.getAPVTS().getParameter ("Morph")->setValueNotifyingHost (0.9f);
+        juce::MemoryBlock afterMove;
+        testPlugin.getStateInformation (afterMove);
+        CHECK (afterMove != afterEdit);
+
+        PluginProcessor restored;
+        restored.setStateInformation (afterMove.getData(), (int) afterMove.getSize());
+        CHECK (restored.getHarm1Data()[1] == 0.5f);
+    }
+}
+
+TEST_CASE ("Link groups", "[instance]")
+{
+    PluginProcessor first, second;
+    first.setBankTable (0, { 1.0f, 0.5f });
+    first.setLinkGroup ("Strings");
+    second.setLinkGroup ("Strings");
+
+    SECTION ("joining a group takes on its tables")
+    {
+        CHECK (second.getLinkGroup() == "Strings");
+        CHECK (second.getHarm1Data()[1] == 0.5f);
+    }
+
+    SECTION ("an edit in one member reaches the others")
+    {
+        second.setBankTable (1, { 0.25f, 0.75f });
+        first.handlePendingChangesNow();
+        CHECK (first.getHarm2Data()[1] == 0.75f);
+        CHECK (first.takeOutsideChanges());
+        CHECK_FALSE (first.takeOutsideChanges());
+    }
+
+    SECTION ("every member plays the morph of whichever moved it")
+    {
+        second.setBankTable (1, { 0.25f, 0.75f });
+
+        first.prepareToPlay (48000.0, 512);
+        juce::AudioBuffer<float> buffer (2, 512);
+        juce::MidiBuffer midi;
+        first.processBlock (buffer, midi);
+
+        first.getAPVTS().getParameter ("Morph")->setValueNotifyingHost (1.0f);
+        first.processBlock (buffer, midi);
+
+        CHECK (second.takeOutsideChanges());
+        CHECK (std::abs (second.getComboData()[1] - 0.75f) < 1.0e-4f);
+    }
+
+    SECTION ("an empty name unlinks")
+    {
+        second.setLinkGroup ({});
+        first.setBankTable (0, { 0.0f, 0.1f });
+        CHECK (second.getHarm1Data()[1] == 0.5f);
+        CHECK (second.getLinkGroup().isEmpty());
+    }
+
+    SECTION ("the group is saved with the state")
+    {
+        juce::MemoryBlock state;
+        second.getStateInformation (state);
+
+        PluginProcessor restored;
+        restored.setStateInformation (state.getData(), (int) state.getSize());
+        CHECK (restored.getLinkGroup() == "Strings");
+
+        restored.setBankTable (0, { 0.0f, 0.3f });
+        first.handlePendingChangesNow();
+        CHECK (first.getHarm1Data()[1] == 0.3f);
+    }
+}
 
 #ifdef PAMPLEJUCE_IPP
     #include <ipp.h>
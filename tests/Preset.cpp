@@ -0,0 +1,239 @@
+#include <Preset.h>
+#include <PresetBank.h>
+#include <PresetLibrary.h>
+#include <PresetSaveQueue.h>
+#include <catch2/catch_test_macros.hpp>
+
+static bool parse (const juce::MemoryOutputStream& out, PresetFields& fields)
+{
+    return PresetReader::parse (static_cast<const char*> (out.getData()), out.getDataSize(), fields);
+}
+
+TEST_CASE ("Streaming preset reader", "[preset]")
+{
+    SECTION ("reads files written by the old ValueTree writer")
+    {
+        const char legacy[] = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n\r\n"
+                              "<PRESET morphValue=\"0.75\">\r\n"
+                              "  <HARM1 h0=\"1.0\" h1=\"0.5\" h2=\"0.25\" h3=\"0.0\" h4=\"0.0\" h5=\"0.0\" h6=\"0.0\" h7=\"0.125\"/>\r\n"
+                              "  <HARM2 h0=\"0.1000000014901161\" h1=\"0.0\" h2=\"0.0\" h3=\"0.0\" h4=\"0.0\" h5=\"0.0\" h6=\"0.0\" h7=\"1.0\"/>\r\n"
+                              "  <COMBO h0=\"0.5\" h1=\"0.5\" h2=\"0.5\" h3=\"0.5\" h4=\"0.5\" h5=\"0.5\" h6=\"0.5\" h7=\"0.5\"/>\r\n"
+                              "</PRESET>\r\n";
+
+        PresetFields fields;
+        REQUIRE (PresetReader::parse (legacy, sizeof (legacy) - 1, fields));
+        REQUIRE (fields.morphValue == 0.75f);
+        REQUIRE (fields.harm1[1] == 0.5f);
+        REQUIRE (fields.harm1[7] == 0.125f);
+        REQUIRE (fields.harm2[0] == 0.1f);
+        REQUIRE (fields.harm2[7] == 1.0f);
+        REQUIRE (fields.combo[4] == 0.5f);
+        REQUIRE (fields.hasHarm1);
+        REQUIRE (fields.hasHarm2);
+        REQUIRE (fields.hasCombo);
+    }
+
+    SECTION ("tolerates comments, single quotes, reordering and missing sections")
+    {
+        const char text[] = "<!-- hand edited -->\n<PRESET extra='x' morphValue = '0.5'>"
+                            "<COMBO h3='0.25' unknown='1'/><HARM1 h0=\"1\"></HARM1></PRESET>";
+
+        PresetFields fields;
+        REQUIRE (PresetReader::parse (text, sizeof (text) - 1, fields));
+        REQUIRE (fields.morphValue == 0.5f);
+        REQUIRE (fields.harm1[0] == 1.0f);
+        REQUIRE (fields.combo[3] == 0.25f);
+        REQUIRE_FALSE (fields.hasHarm2);
+
+        auto data = PresetData::fromFields (fields);
+        REQUIRE (data.harm1Data.size() == 8);
+        REQUIRE (data.harm2Data.isEmpty());
+    }
+
+    SECTION ("writer output reads back exactly")
+    {
+        PresetFields written;
+        written.morphValue = 0.3f;
+        for (size_t i = 0; i < written.harm1.size(); ++i)
+        {
+            written.harm1[i] = 1.0f / (float) (i + 1);
+            written.harm2[i] = (float) i * 0.1f;
+            written.combo[i] = 0.7f;
+        }
+
+        juce::MemoryOutputStream out;
+        PresetWriter::write (written, out);
+
+        PresetFields read;
+        REQUIRE (parse (out, read));
+        REQUIRE (read.harm1 == written.harm1);
+        REQUIRE (read.harm2 == written.harm2);
+        REQUIRE (read.combo == written.combo);
+        REQUIRE (read.morphValue == written.morphValue);
+    }
+
+    SECTION ("rejects data without a preset")
+    {
+        PresetFields fields;
+        REQUIRE_FALSE (PresetReader::parse ("<OTHER/>", 8, fields));
+    }
+}
+
+TEST_CASE ("Preset bank", "[preset]")
+{
+    std::vector<PresetBank::Entry> entries;
+    for (int i = 0; i < 5; ++i)
+    {
+        PresetBank::Entry entry;
+        entry.name = "Preset " + juce::String (i);
+        entry.fields.morphValue = (float) i * 0.25f;
+        entry.fields.harm1[(size_t) i] = 1.0f;
+        entry.fields.combo[7] = (float) i;
+        entries.push_back (entry);
+    }
+
+    juce::TemporaryFile bankFile (".presetbank");
+    REQUIRE (PresetBank::write (entries, bankFile.getFile()));
+
+    PresetBank bank;
+    REQUIRE (bank.open (bankFile.getFile()));
+    REQUIRE (bank.getNumPresets() == 5);
+    REQUIRE (bank.getName (3) == "Preset 3");
+    REQUIRE (bank.indexOf ("Preset 4") == 4);
+
+    PresetFields fields;
+    REQUIRE (bank.getPreset (2, fields));
+    REQUIRE (fields.harm1 == entries[2].fields.harm1);
+    REQUIRE (fields.combo[7] == 2.0f);
+    REQUIRE (fields.morphValue == 0.5f);
+    REQUIRE_FALSE (bank.getPreset (5, fields));
+
+    SECTION ("rejects files that are not banks")
+    {
+        juce::TemporaryFile other (".presetbank");
+        other.getFile().replaceWithText ("<PRESET/>");
+        REQUIRE_FALSE (bank.open (other.getFile()));
+        REQUIRE (bank.getNumPresets() == 0);
+    }
+
+    SECTION ("a failed write anywhere in the records fails the whole bank")
+    {
+        // Refuses the one write that covers failAt and takes everything else
+        struct FaultyStream : juce::OutputStream
+        {
+            explicit FaultyStream (size_t position) : failAt (position) {}
+
+            bool write (const void*, size_t numBytes) override
+            {
+                if (written <= failAt && failAt < written + numBytes)
+                {
+                    failAt = std::numeric_limits<size_t>::max();
+                    return false;
+                }
+
+                written += numBytes;
+                return true;
+            }
+
+            void flush() override {}
+            bool setPosition (juce::int64) override { return false; }
+            juce::int64 getPosition() override { return (juce::int64) written; }
+
+            size_t failAt, written = 0;
+        };
+
+        juce::MemoryOutputStream whole;
+        REQUIRE (PresetBank::write (entries, whole));
+
+        // The second float of the last record's harm1
+        FaultyStream out (whole.getDataSize() - PresetBank::floatsPerRecord * sizeof (float) + sizeof (float));
+        REQUIRE_FALSE (PresetBank::write (entries, out));
+    }
+}
+
+TEST_CASE ("Background preset saving", "[preset]")
+{
+    juce::TemporaryFile target (".preset");
+
+    SECTION ("the last of a burst of saves is what ends up on disk")
+    {
+        // Held back while the saves queue up, so they all coalesce into one write
+        PresetSaveQueue queue;
+        queue.pause();
+        for (int i = 0; i < 20; ++i)
+        {
+            PresetFields fields;
+            fields.morphValue = 0.5f * (float) i;
+            fields.harm1[0] = 1.0f;
+            fields.hasHarm1 = true;
+            queue.save (target.getFile(), fields);
+        }
+
+        queue.waitUntilWritten();
+        CHECK (queue.getNumWritten() == 0);
+
+        queue.resume();
+        queue.waitUntilWritten();
+        CHECK (queue.getNumWritten() == 1);
+
+        PresetFields fields;
+        juce::MemoryBlock scratch;
+        REQUIRE (PresetReader::readFile (target.getFile(), fields, scratch));
+        CHECK (fields.morphValue == 9.5f);
+        CHECK (fields.harm1[0] == 1.0f);
+    }
+
+    SECTION ("saving over a preset replaces it whole")
+    {
+        PresetFields first;
+        first.morphValue = 0.25f;
+        REQUIRE (PresetWriter::writeToFile (first, target.getFile()));
+
+        PresetFields second;
+        second.morphValue = 0.75f;
+        REQUIRE (PresetWriter::writeToFile (second, target.getFile()));
+
+        PresetFields fields;
+        juce::MemoryBlock scratch;
+        REQUIRE (PresetReader::readFile (target.getFile(), fields, scratch));
+        CHECK (fields.morphValue == 0.75f);
+    }
+}
+
+TEST_CASE ("Similar preset search", "[preset]")
+{
+    std::vector<PresetBank::Entry> entries (100);
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        entries[i].name = "Preset " + juce::String ((int) i);
+        entries[i].fields.combo.fill ((float) i / 100.0f);
+    }
+
+    auto index = PresetLibrary::createIndex (entries);
+    REQUIRE (index->getNumPresets() == 100);
+    REQUIRE (index->getName (42) == "Preset 42");
+    REQUIRE (reinterpret_cast<std::uintptr_t> (index->getVectors()) % 32 == 0);
+
+    HarmonicTable query {};
+    query.fill (0.421f);
+
+    std::vector<PresetLibrary::Match> best;
+    PresetLibrary::findNearest (index->getVectors(), 0, index->getNumPresets(), query.data(), 3, best);
+
+    REQUIRE (best.size() == 3);
+    REQUIRE (best[0].index == 42);
+    REQUIRE (best[1].index == 43);
+    REQUIRE (best[2].index == 41);
+    REQUIRE (best[0].distance <= best[1].distance);
+
+    SECTION ("searching in chunks gives the same answer")
+    {
+        std::vector<PresetLibrary::Match> chunked;
+        PresetLibrary::findNearest (index->getVectors(), 0, 40, query.data(), 3, chunked);
+        PresetLibrary::findNearest (index->getVectors(), 40, 100, query.data(), 3, chunked);
+
+        REQUIRE (chunked.size() == 3);
+        for (size_t i = 0; i < 3; ++i)
+            REQUIRE (chunked[i].index == best[i].index);
+    }
+}
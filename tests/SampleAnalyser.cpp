@@ -0,0 +1,95 @@
+#include <SampleAnalyser.h>
+#include <catch2/catch_test_macros.hpp>
+
+// A steady tone with the given harmonic amplitudes, [0] being the fundamental
+static juce::AudioBuffer<float> harmonicTone (double sampleRate, float frequency, std::initializer_list<float> amplitudes, int numSamples)
+{
+    juce::AudioBuffer<float> buffer (1, numSamples);
+    buffer.clear();
+
+    int harmonic = 1;
+    for (const float amplitude : amplitudes)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            buffer.getWritePointer (0)[i] += 0.5f * amplitude * std::sin (juce::MathConstants<float>::twoPi * frequency * (float) harmonic * (float) i / (float) sampleRate);
+        ++harmonic;
+    }
+
+    return buffer;
+}
+
+TEST_CASE ("Sample analysis", "[analysis]")
+{
+    constexpr double sampleRate = 48000.0;
+    SampleAnalyser::Options options;
+    options.fftOrder = 13;
+
+    // Fundamental, octave, 3rd harmonic and 5th harmonic
+    const auto tone = harmonicTone (sampleRate, 220.0f, { 1.0f, 0.5f, 0.25f, 0.0f, 0.1f }, 48000);
+
+    SECTION ("the fundamental is the median pitch")
+    {
+        const float fundamental = SampleAnalyser::estimateFundamental (tone.getReadPointer (0), tone.getNumSamples(), sampleRate);
+        REQUIRE (fundamental > 219.0f);
+        REQUIRE (fundamental < 221.0f);
+    }
+
+    SECTION ("harmonics are measured relative to the fundamental")
+    {
+        SampleAnalyser::Result result;
+        REQUIRE (SampleAnalyser::analyseBuffer (tone, sampleRate, options, result));
+        REQUIRE (result.numWindows == 1 + (48000 - 8192) / 4096);
+
+        const HarmonicTable expected { 0.5f, 0.25f, 0.0f, 0.1f, 0.0f, 0.0f, 0.0f, 0.0f };
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            INFO ("harmonic " << i + 2);
+            REQUIRE (std::abs (result.table[i] - expected[i]) < 0.02f);
+        }
+    }
+
+    SECTION ("silent windows are left out of the average")
+    {
+        juce::AudioBuffer<float> padded (1, 2 * 48000);
+        padded.clear();
+        padded.copyFrom (0, 24000, tone.getReadPointer (0), tone.getNumSamples());
+
+        SampleAnalyser::Result result;
+        REQUIRE (SampleAnalyser::analyseBuffer (padded, sampleRate, options, result));
+        REQUIRE (result.numWindows < 1 + (2 * 48000 - 8192) / 4096);
+        REQUIRE (std::abs (result.table[0] - 0.5f) < 0.02f);
+    }
+
+    SECTION ("a sample shorter than a window is one zero padded window")
+    {
+        options.fftOrder = 14;
+        const auto shortTone = harmonicTone (sampleRate, 440.0f, { 1.0f, 0.5f }, 12000);
+
+        SampleAnalyser::Result result;
+        REQUIRE (SampleAnalyser::analyseBuffer (shortTone, sampleRate, options, result));
+        REQUIRE (result.numWindows == 1);
+        REQUIRE (std::abs (result.table[0] - 0.5f) < 0.02f);
+    }
+
+    SECTION ("silence has no pitch to analyse")
+    {
+        juce::AudioBuffer<float> silence (1, 48000);
+        silence.clear();
+
+        SampleAnalyser::Result result;
+        REQUIRE_FALSE (SampleAnalyser::analyseBuffer (silence, sampleRate, options, result));
+        REQUIRE (result.fundamental == 0.0f);
+    }
+
+    SECTION ("harmonics louder than the fundamental are clipped")
+    {
+        SampleAnalyser::Magnitudes sums {};
+        sums[0] = 1.0;
+        sums[1] = 2.0;
+        sums[2] = 0.5;
+
+        const auto table = SampleAnalyser::toTable (sums);
+        REQUIRE (table[0] == 1.0f);
+        REQUIRE (table[1] == 0.5f);
+    }
+}
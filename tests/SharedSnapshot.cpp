@@ -0,0 +1,67 @@
+#include <SharedSnapshot.h>
+#include <algorithm>
+#include <array>
+#include <catch2/catch_test_macros.hpp>
+#include <thread>
+
+TEST_CASE ("Shared snapshot", "[snapshot]")
+{
+    // Each value holds the same number everywhere, so a torn or freed read shows up as a mismatch
+    struct Value
+    {
+        std::array<int, 64> numbers {};
+    };
+
+    SharedSnapshot<Value> snapshot;
+
+    SECTION ("readers see whole values while the writer republishes")
+    {
+        std::atomic<bool> done { false };
+        std::atomic<int> badReads { 0 };
+
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; ++r)
+        {
+            readers.emplace_back ([&] {
+                while (! done)
+                {
+                    const bool whole = snapshot.read ([] (const Value& value) {
+                        return std::all_of (value.numbers.begin(), value.numbers.end(), [&] (int n) { return n == value.numbers[0]; });
+                    });
+
+                    if (! whole)
+                        ++badReads;
+                }
+            });
+        }
+
+        for (int i = 1; i <= 2000; ++i)
+        {
+            auto value = std::make_unique<Value>();
+            value->numbers.fill (i);
+            snapshot.publish (std::move (value));
+        }
+
+        done = true;
+        for (auto& reader : readers)
+            reader.join();
+
+        CHECK (badReads == 0);
+        CHECK (snapshot.read ([] (const Value& value) { return value.numbers[0]; }) == 2000);
+    }
+
+    SECTION ("retired values are freed once no reader is in flight")
+    {
+        snapshot.publish (std::make_unique<Value>());
+        CHECK (snapshot.getNumRetired() == 0);
+
+        snapshot.read ([&] (const Value&) {
+            snapshot.publish (std::make_unique<Value>());
+            return 0;
+        });
+        CHECK (snapshot.getNumRetired() == 1);
+
+        snapshot.collectGarbage();
+        CHECK (snapshot.getNumRetired() == 0);
+    }
+}
@@ -0,0 +1,72 @@
+#include <WavetableExporter.h>
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE ("Wavetable export", "[wavetable]")
+{
+    WavetableExporter::Options options;
+    options.frameSize = 256;
+
+    SECTION ("a frame is one cycle of the fundamental plus the table's harmonics")
+    {
+        HarmonicTable table {};
+        table[0] = 0.5f;  // octave
+        table[2] = 0.25f; // 4th harmonic
+
+        WavetableExporter::Job job { {}, table, table, 1, MorphEngine::Curve::linear };
+        std::vector<float> frame ((size_t) options.frameSize);
+        WavetableExporter::renderFrames (job, options, 0, 1, frame.data());
+
+        float worst = 0.0f;
+        for (int n = 0; n < options.frameSize; ++n)
+        {
+            const float w = juce::MathConstants<float>::twoPi * (float) n / (float) options.frameSize;
+            const float expected = std::sin (w) + 0.5f * std::sin (2.0f * w) + 0.25f * std::sin (4.0f * w);
+            worst = juce::jmax (worst, std::abs (frame[(size_t) n] - expected));
+        }
+        REQUIRE (worst < 1.0e-4f);
+    }
+
+    SECTION ("a sweep runs from the first table to the second")
+    {
+        HarmonicTable from {}, to {};
+        to[0] = 1.0f;
+
+        WavetableExporter::Job job { {}, from, to, 3, MorphEngine::Curve::linear };
+        options.includeFundamental = false;
+        std::vector<float> frames ((size_t) (3 * options.frameSize));
+        WavetableExporter::renderFrames (job, options, 0, 3, frames.data());
+
+        auto peakOf = [&] (int frame) {
+            float peak = 0.0f;
+            for (int n = 0; n < options.frameSize; ++n)
+                peak = juce::jmax (peak, std::abs (frames[(size_t) (frame * options.frameSize + n)]));
+            return peak;
+        };
+
+        REQUIRE (peakOf (0) == 0.0f);
+        REQUIRE (std::abs (peakOf (1) - 0.5f) < 1.0e-3f);
+        REQUIRE (std::abs (peakOf (2) - 1.0f) < 1.0e-3f);
+    }
+
+    SECTION ("the WAV has a frame size marker and every frame")
+    {
+        std::vector<float> frames ((size_t) (2 * options.frameSize), 0.25f);
+        juce::MemoryOutputStream out;
+        REQUIRE (WavetableExporter::writeWav (out, frames.data(), 2, options.frameSize, 44100.0));
+
+        const auto* bytes = static_cast<const char*> (out.getData());
+        const std::string header (bytes, bytes + 64);
+        REQUIRE (header.substr (0, 4) == "RIFF");
+        REQUIRE (header.substr (8, 4) == "WAVE");
+        REQUIRE (header.find ("clm ") != std::string::npos);
+        REQUIRE (header.find ("<!>256 ") != std::string::npos);
+
+        int riffSize = 0;
+        std::memcpy (&riffSize, bytes + 4, 4);
+        REQUIRE ((size_t) riffSize + 8 == out.getDataSize());
+
+        float last = 0.0f;
+        std::memcpy (&last, bytes + out.getDataSize() - 4, 4);
+        REQUIRE (last == 0.25f);
+    }
+}
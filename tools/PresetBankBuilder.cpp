@@ -0,0 +1,60 @@
+// Builds a single file preset bank from a directory of .preset files.
+//
+// Usage: PresetBankBuilder <preset directory> <output bank>
+//
+// Presets are stored in file name order, named after the file without its
+// extension. Runs as part of the build, see CMakeLists.txt.
+
+#include <iostream>
+#include <juce_core/juce_core.h>
+#include "PresetBank.h"
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: PresetBankBuilder <preset directory> <output bank>" << std::endl;
+        return 1;
+    }
+
+    const juce::File sourceDirectory(juce::File::getCurrentWorkingDirectory().getChildFile(argv[1]));
+    const juce::File target(juce::File::getCurrentWorkingDirectory().getChildFile(argv[2]));
+
+    if (! sourceDirectory.isDirectory())
+    {
+        std::cerr << "Not a directory: " << sourceDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    auto files = sourceDirectory.findChildFiles(juce::File::findFiles, false, "*.preset");
+    files.sort();
+
+    std::vector<PresetBank::Entry> entries;
+    entries.reserve((size_t) files.size());
+    juce::MemoryBlock scratch;
+
+    for (const auto& file : files)
+    {
+        PresetBank::Entry entry;
+        entry.name = file.getFileNameWithoutExtension();
+
+        if (! PresetReader::readFile(file, entry.fields, scratch))
+        {
+            std::cerr << "Skipping unreadable preset: " << file.getFullPathName() << std::endl;
+            continue;
+        }
+
+        entries.push_back(std::move(entry));
+    }
+
+    target.getParentDirectory().createDirectory();
+
+    if (! PresetBank::write(entries, target))
+    {
+        std::cerr << "Could not write " << target.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Wrote " << entries.size() << " presets to " << target.getFullPathName() << std::endl;
+    return 0;
+}